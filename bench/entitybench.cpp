@@ -0,0 +1,467 @@
+//Microbenchmarks of the entity module. Built as fea-entity-bench when BUILD_BENCHMARKS is enabled.
+//Every result is printed as one JSON object per line, with the median time and heap allocations per operation over all repetitions.
+#include <fea/entitysystem.hpp>
+#ifdef USE_JSONCPP
+#include <fea/entity/jsonentityloader.hpp>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//every allocation made by the process is counted, so that allocations per operation can be reported
+static std::atomic<uint64_t> gAllocations(0);
+
+//all replaced allocation functions go through these. Keeping them out of line stops GCC from pairing an inlined free with an operator new call and warning about a mismatch
+#if defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+static BENCH_NOINLINE void* countedAllocate(std::size_t size) noexcept
+{
+    gAllocations++;
+    return std::malloc(size ? size : 1);
+}
+
+static BENCH_NOINLINE void countedFree(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void* operator new(std::size_t size)
+{
+    if(void* memory = countedAllocate(size))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if(void* memory = countedAllocate(size))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    countedFree(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    countedFree(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+    countedFree(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+    countedFree(memory);
+}
+
+#if __cpp_sized_deallocation
+void operator delete(void* memory, std::size_t) noexcept
+{
+    countedFree(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    countedFree(memory);
+}
+#endif
+
+namespace
+{
+    struct Settings
+    {
+        std::vector<uint32_t> mEntityCounts;
+        uint32_t mRepetitions;
+        std::string mFilter;
+    };
+
+    //measures the part of a benchmark between start and stop, so that setup and teardown are excluded
+    class Timer
+    {
+        public:
+            void start()
+            {
+                mAllocations = gAllocations;
+                mStart = std::chrono::steady_clock::now();
+            }
+
+            void stop()
+            {
+                auto end = std::chrono::steady_clock::now();
+                mNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(end - mStart).count();
+                mAllocationsMade += gAllocations - mAllocations;
+            }
+
+            double mNanoseconds = 0.0;
+            uint64_t mAllocationsMade = 0;
+        private:
+            std::chrono::steady_clock::time_point mStart;
+            uint64_t mAllocations = 0;
+    };
+
+    //a benchmark is run with a given entity count, and returns the amount of operations it timed
+    using Benchmark = std::function<uint64_t(fea::EntityStorage::StorageLayout, uint32_t, Timer&)>;
+
+    const char* layoutName(fea::EntityStorage::StorageLayout layout)
+    {
+        return layout == fea::EntityStorage::COLUMNS ? "columns" : "archetypes";
+    }
+
+    void run(const Settings& settings, const std::string& name, bool perLayout, Benchmark benchmark)
+    {
+        if(!settings.mFilter.empty() && name.find(settings.mFilter) == std::string::npos)
+            return;
+
+        std::vector<fea::EntityStorage::StorageLayout> layouts{fea::EntityStorage::COLUMNS};
+        if(perLayout)
+            layouts.push_back(fea::EntityStorage::ARCHETYPES);
+
+        for(auto layout : layouts)
+        {
+            for(uint32_t entities : settings.mEntityCounts)
+            {
+                //the median of the repetitions is reported, to be robust against scheduling noise
+                std::vector<double> nanoseconds;
+                std::vector<double> allocations;
+
+                for(uint32_t repetition = 0; repetition < settings.mRepetitions; repetition++)
+                {
+                    Timer timer;
+                    uint64_t operations = std::max<uint64_t>(1, benchmark(layout, entities, timer));
+                    nanoseconds.push_back(timer.mNanoseconds / operations);
+                    allocations.push_back(static_cast<double>(timer.mAllocationsMade) / operations);
+                }
+
+                std::sort(nanoseconds.begin(), nanoseconds.end());
+                std::sort(allocations.begin(), allocations.end());
+
+                std::printf("{\"benchmark\":\"%s\",\"layout\":\"%s\",\"entities\":%u,\"repetitions\":%u,\"ns_per_op\":%.3f,\"allocs_per_op\":%.4f}\n",
+                        name.c_str(), perLayout ? layoutName(layout) : "none", entities, settings.mRepetitions, nanoseconds[nanoseconds.size() / 2], allocations[allocations.size() / 2]);
+                std::fflush(stdout);
+            }
+        }
+    }
+
+    //one operation is creating and removing one entity, measured after a first round so that slots are reused
+    uint64_t createRemove(fea::EntityStorage::StorageLayout layout, uint32_t entities, Timer& timer)
+    {
+        fea::EntityManager manager(layout);
+        manager.registerAttribute<float>("x");
+        manager.registerAttribute<float>("y");
+        manager.registerAttribute<int32_t>("health");
+
+        std::vector<fea::EntityId> ids(entities);
+
+        for(uint32_t round = 0; round < 2; round++)
+        {
+            if(round == 1)
+                timer.start();
+
+            for(uint32_t i = 0; i < entities; i++)
+                ids[i] = manager.createHandle({"x", "y", "health"}).getId();
+
+            for(uint32_t i = 0; i < entities; i++)
+                manager.removeEntity(ids[i]);
+
+            if(round == 1)
+                timer.stop();
+        }
+
+        return entities;
+    }
+
+    //one operation is setting and getting an attribute by name
+    uint64_t setGetByName(fea::EntityStorage::StorageLayout layout, uint32_t entities, Timer& timer)
+    {
+        fea::EntityManager manager(layout);
+        manager.registerAttribute<float>("x");
+        manager.registerAttribute<float>("y");
+        std::vector<fea::EntityHandle> handles = manager.createHandles({"x", "y"}, entities);
+
+        float sum = 0.0f;
+        timer.start();
+
+        for(uint32_t i = 0; i < entities; i++)
+        {
+            handles[i].setAttribute<float>("x", static_cast<float>(i));
+            sum += handles[i].getAttribute<float>("x");
+        }
+
+        timer.stop();
+
+        //keeps the loop from being optimized away
+        if(sum < 0.0f)
+            std::printf("%f\n", sum);
+
+        return entities;
+    }
+
+    //one operation is visiting one entity with a query over K attributes
+    template<uint32_t K>
+    uint64_t iterate(fea::EntityStorage::StorageLayout layout, uint32_t entities, Timer& timer)
+    {
+        fea::EntityManager manager(layout);
+        manager.registerAttribute<float>("a");
+        manager.registerAttribute<float>("b");
+        manager.registerAttribute<float>("c");
+        manager.registerAttribute<float>("d");
+        manager.createHandles({"a", "b", "c", "d"}, entities);
+
+        //queries are cached by the manager, so create them before timing
+        manager.query<float>({"a"});
+        manager.query<float, float>({"a", "b"});
+        manager.query<float, float, float, float>({"a", "b", "c", "d"});
+
+        float sum = 0.0f;
+        const uint32_t passes = 10;
+        timer.start();
+
+        for(uint32_t pass = 0; pass < passes; pass++)
+        {
+            if(K == 1)
+            {
+                manager.query<float>({"a"}).forEach([&] (fea::EntityId, float& a)
+                {
+                    a += 1.0f;
+                    sum += a;
+                });
+            }
+            else if(K == 2)
+            {
+                manager.query<float, float>({"a", "b"}).forEach([&] (fea::EntityId, float& a, float& b)
+                {
+                    a += b;
+                    sum += a;
+                });
+            }
+            else
+            {
+                manager.query<float, float, float, float>({"a", "b", "c", "d"}).forEach([&] (fea::EntityId, float& a, float& b, float& c, float& d)
+                {
+                    a += b * c + d;
+                    sum += a;
+                });
+            }
+        }
+
+        timer.stop();
+
+        if(sum < 0.0f)
+            std::printf("%f\n", sum);
+
+        return static_cast<uint64_t>(entities) * passes;
+    }
+
+    //one operation is instantiating one entity from a template inheriting two levels of templates
+    uint64_t instantiateInherited(fea::EntityStorage::StorageLayout layout, uint32_t entities, Timer& timer)
+    {
+        fea::EntityManager manager(layout);
+        fea::EntityFactory factory(manager);
+        fea::addBasicDataTypes(factory);
+        factory.registerAttribute("x", "float");
+        factory.registerAttribute("y", "float");
+        factory.registerAttribute("health", "int32");
+        factory.registerAttribute("name", "string");
+
+        fea::EntityTemplate physical;
+        physical.mAttributes = {{"x", "1.0"}, {"y", "2.0"}};
+        fea::EntityTemplate living;
+        living.mInherits = {"physical"};
+        living.mAttributes = {{"health", "100"}};
+        fea::EntityTemplate goblin;
+        goblin.mInherits = {"living"};
+        goblin.mAttributes = {{"name", "goblin"}, {"health", "30"}};
+
+        factory.addTemplate("physical", physical);
+        factory.addTemplate("living", living);
+        factory.addTemplate("goblin", goblin);
+
+        timer.start();
+        factory.instantiate("goblin", entities);
+        timer.stop();
+
+        return entities;
+    }
+
+    //one operation is instantiating one entity from a template with text defaults too long for small string optimization. With copy-on-write, the entities share the text of the template
+    template<bool CopyOnWrite>
+    uint64_t instantiateText(fea::EntityStorage::StorageLayout layout, uint32_t entities, Timer& timer)
+    {
+        fea::EntityManager manager(layout);
+        fea::EntityFactory factory(manager);
+        fea::addBasicDataTypes(factory);
+        factory.registerAttribute("x", "float");
+        factory.registerAttribute("name", "string");
+        factory.registerAttribute("description", "string");
+
+        fea::EntityTemplate citizen;
+        citizen.mAttributes = {{"x", "1.0"}, {"name", "a citizen of the town of Fea"}, {"description", "minds their own business unless spoken to"}};
+        factory.addTemplate("citizen", citizen);
+        factory.setCopyOnWrite("citizen", CopyOnWrite);
+
+        timer.start();
+        factory.instantiate("citizen", entities);
+        timer.stop();
+
+        return entities;
+    }
+
+    //one operation is creating one copy of an entity which has been modified after creation
+    uint64_t cloneEntity(fea::EntityStorage::StorageLayout layout, uint32_t entities, Timer& timer)
+    {
+        fea::EntityManager manager(layout);
+        manager.registerAttribute<float>("x");
+        manager.registerAttribute<float>("y");
+        manager.registerAttribute<int32_t>("health");
+        manager.registerAttribute<std::string>("name");
+
+        fea::EntityHandle original = manager.createHandle({"x", "y", "health", "name"});
+        original.setAttribute<float>("x", 3.0f);
+        original.setAttribute<int32_t>("health", 50);
+        original.setAttribute<std::string>("name", "goblin");
+
+        timer.start();
+        manager.clone(original.getId(), entities);
+        timer.stop();
+
+        return entities;
+    }
+
+#ifdef USE_JSONCPP
+    void writeJsonTemplates(const std::string& path, uint32_t templates)
+    {
+        std::ofstream file(path);
+        file << "{\"entities\":[{\"name\":\"base\",\"attributes\":{\"x\":\"0.0\",\"y\":\"0.0\"}}";
+
+        for(uint32_t i = 0; i < templates; i++)
+            file << ",{\"name\":\"t" << i << "\",\"inherits\":[\"base\"],\"attributes\":{\"health\":\"" << i % 100 << "\",\"x\":\"" << i << ".5\"}}";
+
+        file << "]}";
+    }
+
+    //one operation is loading and adding one template from a JSON file, every template inheriting a common one. When cached, the templates come from a binary cache written by a previous load
+    template<bool Cached>
+    uint64_t loadJsonTemplates(fea::EntityStorage::StorageLayout layout, uint32_t templates, Timer& timer)
+    {
+        const std::string path = "fea-entity-bench-templates.json";
+        const std::string cachePath = "fea-entity-bench-templates.cache";
+        writeJsonTemplates(path, templates);
+        std::remove(cachePath.c_str());
+
+        for(uint32_t round = 0; round < (Cached ? 2 : 1); round++)
+        {
+            fea::EntityManager manager(layout);
+            fea::EntityFactory factory(manager);
+            fea::addBasicDataTypes(factory);
+            factory.registerAttribute("x", "float");
+            factory.registerAttribute("y", "float");
+            factory.registerAttribute("health", "int32");
+
+            if(round + 1 == (Cached ? 2 : 1))
+                timer.start();
+
+            fea::JsonEntityLoader loader;
+
+            if(Cached)
+            {
+                loader.loadEntityTemplates({path}, factory, cachePath);
+            }
+            else
+            {
+                for(const auto& entityTemplate : loader.loadEntityTemplates(path))
+                    factory.addTemplate(entityTemplate.first, entityTemplate.second);
+            }
+
+            if(round + 1 == (Cached ? 2 : 1))
+                timer.stop();
+        }
+
+        std::remove(path.c_str());
+        std::remove(cachePath.c_str());
+
+        return templates + 1;
+    }
+#endif
+
+    std::vector<uint32_t> parseCounts(const std::string& list)
+    {
+        std::vector<uint32_t> counts;
+        std::stringstream stream(list);
+        std::string count;
+
+        while(std::getline(stream, count, ','))
+            counts.push_back(static_cast<uint32_t>(std::stoul(count)));
+
+        return counts;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Settings settings;
+    settings.mEntityCounts = {100, 1000, 10000, 100000};
+    settings.mRepetitions = 5;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+
+        if(argument == "--entities" && i + 1 < argc)
+            settings.mEntityCounts = parseCounts(argv[++i]);
+        else if(argument == "--repetitions" && i + 1 < argc)
+            settings.mRepetitions = std::max(1, std::atoi(argv[++i]));
+        else if(argument == "--filter" && i + 1 < argc)
+            settings.mFilter = argv[++i];
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--entities 100,1000,...] [--repetitions n] [--filter name]\n"
+                    "Prints one JSON object per benchmark, entity count and storage layout.\n", argv[0]);
+            return 1;
+        }
+    }
+
+    run(settings, "create_remove", true, createRemove);
+    run(settings, "set_get_by_name", true, setGetByName);
+    run(settings, "iterate_1", true, iterate<1>);
+    run(settings, "iterate_2", true, iterate<2>);
+    run(settings, "iterate_4", true, iterate<4>);
+    run(settings, "instantiate_inherited", true, instantiateInherited);
+    run(settings, "instantiate_text", true, instantiateText<false>);
+    run(settings, "instantiate_text_copy_on_write", true, instantiateText<true>);
+    run(settings, "clone", true, cloneEntity);
+#ifdef USE_JSONCPP
+    run(settings, "load_json_templates", false, loadJsonTemplates<false>);
+    run(settings, "load_json_templates_cached", false, loadJsonTemplates<true>);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include <fea/config.hpp>
+#include <memory>
+#include <vector>
+#include <fea/entity/attributetype.hpp>
+#include <fea/entity/chunkpool.hpp>
+#include <fea/entity/sparseset.hpp>
+
+namespace fea
+{
+    class FEA_API Archetype
+    {
+        public:
+            static const uint32_t ChunkSize = 16384;
+
+            Archetype(const std::vector<uint32_t>& attributes, const std::vector<AttributeType>& types, ChunkPool& pool);
+            Archetype(const Archetype&) = delete;
+            Archetype& operator=(const Archetype&) = delete;
+            ~Archetype();
+            const std::vector<uint32_t>& getAttributes() const;
+            bool hasAttribute(uint32_t attribute) const;
+            bool has(uint32_t id) const;
+            uint32_t add(uint32_t id);
+            void remove(uint32_t id);
+            void reserve(uint32_t amount);
+            void* getValue(uint32_t id, uint32_t attribute);
+            const void* getValue(uint32_t id, uint32_t attribute) const;
+            uint32_t size() const;
+            const std::vector<uint32_t>& getIds() const;
+            uint64_t getReservedIdBytes() const;
+            uint32_t getChunkCapacity() const;
+            uint32_t getChunkCount() const;
+            void* getChunkData(uint32_t chunk, uint32_t attribute);
+            void clear();
+        private:
+            unsigned char* getRow(uint32_t row, uint32_t column);
+            void allocateChunk();
+            void releaseChunk();
+            std::vector<uint32_t> mAttributes;
+            std::vector<int32_t> mColumnIndices;
+            std::vector<AttributeType> mTypes;
+            std::vector<uint32_t> mOffsets;
+            uint32_t mChunkCapacity;
+            uint32_t mChunkBytes;
+            std::vector<unsigned char*> mChunks;
+            ChunkPool* mPool;
+            SparseSet mIds;
+    };
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class Archetype
+     *@}
+     ***
+     *  @class Archetype
+     *  @brief Stores all entities which have exactly the same set of attributes.
+     *
+     *  Used by the EntityStorage when it is in the EntityStorage::ARCHETYPES layout. The entities are stored as rows in fixed size chunks of Archetype::ChunkSize bytes. Within a chunk, every attribute has its own packed array, so iterating over one attribute of all entities in a chunk touches contiguous memory. Chunks are only allocated when the previous one is full, and come from the ChunkPool of the EntityStorage, which means that creating many entities with the same attributes costs only a few allocations and that chunks freed by one archetype are reused by others.
+     *
+     *  When an entity is removed, the last row is moved into its place to keep the rows packed.
+     ***
+     *  @var Archetype::ChunkSize
+     *  @brief Size in bytes of every chunk. If a single row does not fit, the chunks are made big enough to hold one row.
+     ***
+     *  @fn Archetype::Archetype(const std::vector<uint32_t>& attributes, const std::vector<AttributeType>& types, ChunkPool& pool)
+     *  @brief Construct an archetype for a set of attributes.
+     *  @param attributes Sorted indices of the attributes.
+     *  @param types Types of all registered attributes, indexed by attribute index.
+     *  @param pool Pool to take the chunks from. Must outlive the archetype.
+     ***
+     *  @fn Archetype::~Archetype()
+     *  @brief Destroy all stored values and give the chunks back to the pool.
+     ***
+     *  @fn const std::vector<uint32_t>& Archetype::getAttributes() const
+     *  @brief Get the sorted indices of the attributes of the archetype.
+     *  @return Attribute indices.
+     ***
+     *  @fn bool Archetype::hasAttribute(uint32_t attribute) const
+     *  @brief Check if the archetype has an attribute.
+     *  @param attribute Index of the attribute.
+     *  @return True if it has the attribute.
+     ***
+     *  @fn bool Archetype::has(uint32_t id) const
+     *  @brief Check if an entity is stored in the archetype.
+     *  @param id ID of the entity.
+     *  @return True if it is stored.
+     ***
+     *  @fn uint32_t Archetype::add(uint32_t id)
+     *  @brief Add an entity with value initialized attributes to the end of the archetype.
+     *
+     *  Assert/undefined behavior if the entity is already stored.
+     *  @param id ID of the entity.
+     *  @return Row of the entity.
+     ***
+     *  @fn void Archetype::remove(uint32_t id)
+     *  @brief Remove an entity, moving the last row into its place.
+     *
+     *  Assert/undefined behavior if the entity is not stored.
+     *  @param id ID of the entity.
+     ***
+     *  @fn void Archetype::reserve(uint32_t amount)
+     *  @brief Allocate enough chunks to hold a given amount of entities.
+     *  @param amount Amount of entities.
+     ***
+     *  @fn void* Archetype::getValue(uint32_t id, uint32_t attribute)
+     *  @brief Get a pointer to an attribute value of an entity.
+     *
+     *  Assert/undefined behavior if the entity is not stored or the archetype does not have the attribute.
+     *  @param id ID of the entity.
+     *  @param attribute Index of the attribute.
+     *  @return Pointer to the value.
+     ***
+     *  @fn const void* Archetype::getValue(uint32_t id, uint32_t attribute) const
+     *  @brief Get a pointer to an attribute value of an entity.
+     *
+     *  Assert/undefined behavior if the entity is not stored or the archetype does not have the attribute.
+     *  @param id ID of the entity.
+     *  @param attribute Index of the attribute.
+     *  @return Pointer to the value.
+     ***
+     *  @fn uint32_t Archetype::size() const
+     *  @brief Get the amount of stored entities.
+     *  @return Amount of entities.
+     ***
+     *  @fn const std::vector<uint32_t>& Archetype::getIds() const
+     *  @brief Get the IDs of the stored entities, indexed by row.
+     *  @return IDs.
+     ***
+     *  @fn uint64_t Archetype::getReservedIdBytes() const
+     *  @brief Get the amount of memory allocated for keeping track of which entities are stored in which row.
+     *  @return Size in bytes.
+     ***
+     *  @fn uint32_t Archetype::getChunkCapacity() const
+     *  @brief Get the amount of rows which fit in one chunk.
+     *  @return Rows per chunk.
+     ***
+     *  @fn uint32_t Archetype::getChunkCount() const
+     *  @brief Get the amount of allocated chunks.
+     *  @return Amount of chunks.
+     ***
+     *  @fn void* Archetype::getChunkData(uint32_t chunk, uint32_t attribute)
+     *  @brief Get a pointer to the packed values of an attribute in a chunk.
+     *
+     *  The value of row r is found at index r modulo Archetype::getChunkCapacity in chunk r divided by Archetype::getChunkCapacity.
+     *  Assert/undefined behavior if the chunk does not exist or the archetype does not have the attribute.
+     *  @param chunk Index of the chunk.
+     *  @param attribute Index of the attribute.
+     *  @return Pointer to the first value.
+     ***
+     *  @fn void Archetype::clear()
+     *  @brief Remove all entities and give the chunks back to the pool.
+     ***/
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include <fea/config.hpp>
+#include <deque>
+#include <typeindex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fea/assert.hpp>
+#include <fea/entity/sparseset.hpp>
+
+namespace fea
+{
+    class FEA_API AttributeColumnBase
+    {
+        public:
+            AttributeColumnBase(std::type_index type);
+            virtual ~AttributeColumnBase();
+            std::type_index getType() const;
+            bool has(uint32_t id) const;
+            uint32_t size() const;
+            uint32_t getIndex(uint32_t id) const;
+            const std::vector<uint32_t>& getIds() const;
+            uint64_t getReservedIdBytes() const;
+            virtual void add(uint32_t id) = 0;
+            virtual void remove(uint32_t id) = 0;
+            virtual void reserve(uint32_t amount) = 0;
+            virtual void clear() = 0;
+            virtual void swap(uint32_t first, uint32_t second) = 0;
+            virtual void* getValue(uint32_t id) = 0;
+            virtual uint32_t capacity() const = 0;
+            virtual uint32_t getAllocationCount() const = 0;
+        protected:
+            std::type_index mType;
+            SparseSet mIds;
+    };
+
+    template<class DataType>
+    class AttributeColumn : public AttributeColumnBase
+    {
+        public:
+            using Storage = typename std::conditional<std::is_same<DataType, bool>::value, std::deque<DataType>, std::vector<DataType>>::type;
+
+            AttributeColumn();
+            void add(uint32_t id) override;
+            void remove(uint32_t id) override;
+            void reserve(uint32_t amount) override;
+            void clear() override;
+            void swap(uint32_t first, uint32_t second) override;
+            void* getValue(uint32_t id) override;
+            uint32_t capacity() const override;
+            uint32_t getAllocationCount() const override;
+            const DataType& get(uint32_t id) const;
+            DataType& get(uint32_t id);
+            const Storage& getValues() const;
+            Storage& getValues();
+        private:
+            static void reserveStorage(std::vector<DataType>& storage, uint32_t amount);
+            static void reserveStorage(std::deque<DataType>& storage, uint32_t amount);
+            static uint32_t storageCapacity(const std::vector<DataType>& storage);
+            static uint32_t storageCapacity(const std::deque<DataType>& storage);
+            Storage mValues;
+    };
+
+#include <fea/entity/attributecolumn.inl>
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class AttributeColumnBase
+     *  @class AttributeColumn
+     *@}
+     ***
+     *  @class AttributeColumnBase
+     *  @brief Type erased base of AttributeColumn.
+     *
+     *  Keeps track of which entities have a value stored in the column. The EntityStorage uses this interface to add and remove entities without knowing the type of the attribute.
+     ***
+     *  @fn AttributeColumnBase::AttributeColumnBase(std::type_index type)
+     *  @brief Construct a column storing values of the given type.
+     *  @param type Type of the values.
+     ***
+     *  @fn virtual AttributeColumnBase::~AttributeColumnBase()
+     *  @brief Destructor.
+     ***
+     *  @fn std::type_index AttributeColumnBase::getType() const
+     *  @brief Get the type of the values stored in the column.
+     *  @return Type.
+     ***
+     *  @fn bool AttributeColumnBase::has(uint32_t id) const
+     *  @brief Check if an entity has a value in the column.
+     *  @param id ID of the entity.
+     *  @return True if the entity has a value.
+     ***
+     *  @fn uint32_t AttributeColumnBase::size() const
+     *  @brief Get the amount of values in the column.
+     *  @return Amount of values.
+     ***
+     *  @fn uint32_t AttributeColumnBase::getIndex(uint32_t id) const
+     *  @brief Get the index of the value of an entity in the column.
+     *
+     *  Assert/undefined behavior if the entity does not have a value.
+     *  @param id ID of the entity.
+     *  @return Index of the value.
+     ***
+     *  @fn const std::vector<uint32_t>& AttributeColumnBase::getIds() const
+     *  @brief Access the IDs of the entities stored in the column.
+     *
+     *  The IDs are in the same order as the values returned by AttributeColumn::getValues, so the value at index i belongs to the entity at index i.
+     *  @return IDs.
+     ***
+     *  @fn uint64_t AttributeColumnBase::getReservedIdBytes() const
+     *  @brief Get the amount of memory allocated for keeping track of which entities are stored in the column.
+     *  @return Size in bytes.
+     ***
+     *  @fn virtual void AttributeColumnBase::add(uint32_t id) = 0
+     *  @brief Add a value initialized value for an entity.
+     *
+     *  Assert/undefined behavior if the entity already has a value.
+     *  @param id ID of the entity.
+     ***
+     *  @fn virtual void AttributeColumnBase::remove(uint32_t id) = 0
+     *  @brief Remove the value of an entity.
+     *
+     *  The last value of the column is moved into the place of the removed value to keep the column packed.
+     *  Assert/undefined behavior if the entity does not have a value.
+     *  @param id ID of the entity.
+     ***
+     *  @fn virtual void AttributeColumnBase::reserve(uint32_t amount) = 0
+     *  @brief Reserve space for a given amount of values.
+     *  @param amount Amount of values.
+     ***
+     *  @fn virtual void AttributeColumnBase::clear() = 0
+     *  @brief Remove all values.
+     ***
+     *  @fn virtual void AttributeColumnBase::swap(uint32_t first, uint32_t second) = 0
+     *  @brief Exchange the places of two values, along with their IDs.
+     *
+     *  Assert/undefined behavior if either index is out of range.
+     *  @param first Index of the first value.
+     *  @param second Index of the second value.
+     ***
+     *  @fn virtual void* AttributeColumnBase::getValue(uint32_t id) = 0
+     *  @brief Get a type erased pointer to the value of an entity.
+     *
+     *  Assert/undefined behavior if the entity does not have a value.
+     *  @param id ID of the entity.
+     *  @return Pointer to the value.
+     ***
+     *  @fn virtual uint32_t AttributeColumnBase::capacity() const = 0
+     *  @brief Get the amount of values the column has room for without allocating.
+     *  @return Amount of values.
+     ***
+     *  @fn virtual uint32_t AttributeColumnBase::getAllocationCount() const = 0
+     *  @brief Get the amount of memory blocks holding the values. The blocks of an std::deque can not be observed, so a column of bool counts as one block when not empty.
+     *  @return Amount of blocks.
+     ***
+     *  @class AttributeColumn
+     *  @brief Stores the values of one attribute for all entities in a contiguous array.
+     *
+     *  The values are packed without gaps, so iterating over AttributeColumn::getValues touches only memory that is in use. Since values are moved when the column grows or when other entities are removed, references to values are only valid until the next structural change of the column.
+     *
+     *  Columns of bool are stored in an std::deque since std::vector<bool> can not hand out references to its elements.
+     *  @tparam DataType Type of the stored values. Must be default constructible.
+     ***
+     *  @typedef AttributeColumn::Storage
+     *  @brief Container type holding the packed values.
+     ***
+     *  @fn AttributeColumn::AttributeColumn()
+     *  @brief Construct an empty column.
+     ***
+     *  @fn const DataType& AttributeColumn::get(uint32_t id) const
+     *  @brief Get the value of an entity.
+     *
+     *  Assert/undefined behavior if the entity does not have a value.
+     *  @param id ID of the entity.
+     *  @return The value.
+     ***
+     *  @fn DataType& AttributeColumn::get(uint32_t id)
+     *  @brief Get the value of an entity.
+     *
+     *  Assert/undefined behavior if the entity does not have a value.
+     *  @param id ID of the entity.
+     *  @return The value.
+     ***
+     *  @fn const Storage& AttributeColumn::getValues() const
+     *  @brief Access the packed values.
+     *  @return Values.
+     ***
+     *  @fn Storage& AttributeColumn::getValues()
+     *  @brief Access the packed values.
+     *  @return Values.
+     ***/
+}
@@ -0,0 +1,110 @@
+template<class DataType>
+AttributeColumn<DataType>::AttributeColumn() : AttributeColumnBase(typeid(DataType))
+{
+}
+
+template<class DataType>
+void AttributeColumn<DataType>::add(uint32_t id)
+{
+    mIds.insert(id);
+    mValues.emplace_back();
+}
+
+template<class DataType>
+void AttributeColumn<DataType>::remove(uint32_t id)
+{
+    uint32_t index = mIds.erase(id);
+
+    if(index != mValues.size() - 1)
+        mValues[index] = std::move(mValues.back());
+
+    mValues.pop_back();
+}
+
+template<class DataType>
+void AttributeColumn<DataType>::reserve(uint32_t amount)
+{
+    mIds.reserve(amount);
+    reserveStorage(mValues, amount);
+}
+
+template<class DataType>
+void AttributeColumn<DataType>::clear()
+{
+    mIds.clear();
+    mValues.clear();
+}
+
+template<class DataType>
+void AttributeColumn<DataType>::swap(uint32_t first, uint32_t second)
+{
+    using std::swap;
+
+    mIds.swap(first, second);
+    swap(mValues[first], mValues[second]);
+}
+
+template<class DataType>
+void* AttributeColumn<DataType>::getValue(uint32_t id)
+{
+    return &get(id);
+}
+
+template<class DataType>
+uint32_t AttributeColumn<DataType>::capacity() const
+{
+    return storageCapacity(mValues);
+}
+
+template<class DataType>
+uint32_t AttributeColumn<DataType>::getAllocationCount() const
+{
+    return capacity() > 0 ? 1 : 0;
+}
+
+template<class DataType>
+const DataType& AttributeColumn<DataType>::get(uint32_t id) const
+{
+    return mValues[mIds.getIndex(id)];
+}
+
+template<class DataType>
+DataType& AttributeColumn<DataType>::get(uint32_t id)
+{
+    return mValues[mIds.getIndex(id)];
+}
+
+template<class DataType>
+const typename AttributeColumn<DataType>::Storage& AttributeColumn<DataType>::getValues() const
+{
+    return mValues;
+}
+
+template<class DataType>
+typename AttributeColumn<DataType>::Storage& AttributeColumn<DataType>::getValues()
+{
+    return mValues;
+}
+
+template<class DataType>
+void AttributeColumn<DataType>::reserveStorage(std::vector<DataType>& storage, uint32_t amount)
+{
+    storage.reserve(amount);
+}
+
+template<class DataType>
+void AttributeColumn<DataType>::reserveStorage(std::deque<DataType>&, uint32_t)
+{
+}
+
+template<class DataType>
+uint32_t AttributeColumn<DataType>::storageCapacity(const std::vector<DataType>& storage)
+{
+    return static_cast<uint32_t>(storage.capacity());
+}
+
+template<class DataType>
+uint32_t AttributeColumn<DataType>::storageCapacity(const std::deque<DataType>& storage)
+{
+    return static_cast<uint32_t>(storage.size());
+}
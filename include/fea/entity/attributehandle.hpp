@@ -0,0 +1,74 @@
+#pragma once
+#include <fea/config.hpp>
+#include <cstdint>
+
+namespace fea
+{
+    template<class DataType>
+    class AttributeHandle
+    {
+        public:
+            using Type = DataType;
+
+            AttributeHandle();
+            explicit AttributeHandle(uint32_t index);
+            uint32_t getIndex() const;
+            bool isValid() const;
+            bool operator==(const AttributeHandle& other) const;
+            bool operator!=(const AttributeHandle& other) const;
+        private:
+            uint32_t mIndex;
+    };
+
+#include <fea/entity/attributehandle.inl>
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class AttributeHandle
+     *@}
+     ***
+     *  @class AttributeHandle
+     *  @brief Pre-resolved reference to a registered attribute.
+     *
+     *  Accessing attributes by name means that the name has to be hashed and looked up on every access. An AttributeHandle is obtained once, either as the return value of EntityManager::registerAttribute or using EntityManager::getAttributeHandle, and can then be used instead of the name. Accessing attributes using a handle is a plain array index without any hashing, and since the handle carries the type of the attribute, the type does not have to be given as a template argument.
+     *  @code
+     *  fea::AttributeHandle<int32_t> health = entityManager.registerAttribute<int32_t>("health");
+     *  //...
+     *  entity->setAttribute(health, 100);
+     *  int32_t current = entityManager.getAttribute(id, health);
+     *  @endcode
+     *
+     *  Handles stay valid until EntityManager::clear is called.
+     *  @tparam DataType Type of the attribute.
+     ***
+     *  @typedef AttributeHandle::Type
+     *  @brief The type of the attribute.
+     ***
+     *  @fn AttributeHandle::AttributeHandle()
+     *  @brief Construct an invalid handle.
+     ***
+     *  @fn AttributeHandle::AttributeHandle(uint32_t index)
+     *  @brief Construct a handle to the attribute with the given index.
+     *
+     *  Handles are not meant to be constructed manually, but retrieved from the EntityManager.
+     *  @param index Index of the attribute.
+     ***
+     *  @fn uint32_t AttributeHandle::getIndex() const
+     *  @brief Get the index of the attribute.
+     *  @return Index.
+     ***
+     *  @fn bool AttributeHandle::isValid() const
+     *  @brief Check if the handle refers to an attribute.
+     *  @return False if the handle was default constructed.
+     ***
+     *  @fn bool AttributeHandle::operator==(const AttributeHandle& other) const
+     *  @brief Check if two handles refer to the same attribute.
+     *  @param other Handle to compare with.
+     *  @return True if they are the same.
+     ***
+     *  @fn bool AttributeHandle::operator!=(const AttributeHandle& other) const
+     *  @brief Check if two handles refer to different attributes.
+     *  @param other Handle to compare with.
+     *  @return True if they are different.
+     ***/
+}
@@ -0,0 +1,33 @@
+template<class DataType>
+AttributeHandle<DataType>::AttributeHandle() : mIndex(static_cast<uint32_t>(-1))
+{
+}
+
+template<class DataType>
+AttributeHandle<DataType>::AttributeHandle(uint32_t index) : mIndex(index)
+{
+}
+
+template<class DataType>
+uint32_t AttributeHandle<DataType>::getIndex() const
+{
+    return mIndex;
+}
+
+template<class DataType>
+bool AttributeHandle<DataType>::isValid() const
+{
+    return mIndex != static_cast<uint32_t>(-1);
+}
+
+template<class DataType>
+bool AttributeHandle<DataType>::operator==(const AttributeHandle& other) const
+{
+    return mIndex == other.mIndex;
+}
+
+template<class DataType>
+bool AttributeHandle<DataType>::operator!=(const AttributeHandle& other) const
+{
+    return mIndex != other.mIndex;
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <fea/config.hpp>
+#include <cstdint>
+#include <set>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <fea/assert.hpp>
+#include <fea/entity/entityid.hpp>
+
+namespace fea
+{
+    class FEA_API AttributeIndexBase
+    {
+        public:
+            static const uint32_t noAttribute = ~0u;
+
+            AttributeIndexBase(uint32_t attribute, std::type_index type, uint32_t secondaryAttribute = noAttribute);
+            virtual ~AttributeIndexBase();
+            uint32_t getAttribute() const;
+            uint32_t getSecondaryAttribute() const;
+            std::type_index getType() const;
+            virtual void update(EntityId id, const void* value, const void* secondaryValue) = 0;
+            virtual void remove(uint32_t index) = 0;
+            virtual void clear() = 0;
+        protected:
+            uint32_t mAttribute;
+            uint32_t mSecondaryAttribute;
+            std::type_index mType;
+            uint32_t mRefreshedFrame;
+            uint64_t mRefreshedMarks;
+            uint64_t mRefreshedSecondaryMarks;
+        friend class EntityStorage;
+    };
+
+    template<class DataType>
+    class HashIndex : public AttributeIndexBase
+    {
+        public:
+            using Type = DataType;
+
+            HashIndex(uint32_t attribute);
+            void update(EntityId id, const void* value, const void* secondaryValue) override;
+            void remove(uint32_t index) override;
+            void clear() override;
+            const std::vector<EntityId>& find(const DataType& value) const;
+        private:
+            void erase(uint32_t index);
+            std::unordered_map<DataType, std::vector<EntityId>> mBuckets;
+            std::vector<DataType> mValues;
+            std::vector<EntityId> mIds;
+            std::vector<uint32_t> mPositions;
+            std::vector<EntityId> mNone;
+    };
+
+    template<class DataType>
+    class SortedIndex : public AttributeIndexBase
+    {
+        public:
+            using Type = DataType;
+
+            SortedIndex(uint32_t attribute);
+            void update(EntityId id, const void* value, const void* secondaryValue) override;
+            void remove(uint32_t index) override;
+            void clear() override;
+            template<class Function>
+            void forEachInRange(const DataType& min, const DataType& max, Function function) const;
+        private:
+            std::set<std::pair<DataType, EntityId>> mEntries;
+            std::vector<DataType> mValues;
+            std::vector<EntityId> mIds;
+    };
+
+#include <fea/entity/attributeindex.inl>
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class AttributeIndexBase
+     *  @class HashIndex
+     *  @class SortedIndex
+     *@}
+     ***
+     *  @class AttributeIndexBase
+     *  @brief Type erased base of the secondary indexes finding entities by attribute value.
+     *
+     *  Indexes are owned by the EntityStorage, which keeps them up to date using the ChangeTracker of the indexed attribute. Changed entities are only re-indexed when the index is next used, so any amount of writes between two lookups costs one update per changed entity. Removed entities are taken out of the index right away.
+     *
+     *  An index can also depend on a secondary attribute of the same type, like the SpatialIndex which needs both the position and the size of an entity. Changes to either attribute then cause the entity to be re-indexed.
+     ***
+     *  @var AttributeIndexBase::noAttribute
+     *  @brief Secondary attribute of indexes which only depend on one attribute.
+     ***
+     *  @fn AttributeIndexBase::AttributeIndexBase(uint32_t attribute, std::type_index type, uint32_t secondaryAttribute = noAttribute)
+     *  @brief Construct an empty index.
+     *  @param attribute Index of the indexed attribute.
+     *  @param type Type of the indexed attribute.
+     *  @param secondaryAttribute Index of the secondary attribute the index depends on, if any.
+     ***
+     *  @fn virtual AttributeIndexBase::~AttributeIndexBase()
+     *  @brief Destructor.
+     ***
+     *  @fn uint32_t AttributeIndexBase::getAttribute() const
+     *  @brief Get the index of the indexed attribute.
+     *  @return Attribute index.
+     ***
+     *  @fn uint32_t AttributeIndexBase::getSecondaryAttribute() const
+     *  @brief Get the index of the secondary attribute.
+     *  @return Attribute index, or AttributeIndexBase::noAttribute if there is none.
+     ***
+     *  @fn std::type_index AttributeIndexBase::getType() const
+     *  @brief Get the type of the indexed attribute.
+     *  @return Type.
+     ***
+     *  @fn virtual void AttributeIndexBase::update(EntityId id, const void* value, const void* secondaryValue) = 0
+     *  @brief Add an entity to the index, or move it if its value changed.
+     *  @param id ID of the entity.
+     *  @param value Pointer to the current value of the attribute, or nullptr if the entity does not have it.
+     *  @param secondaryValue Pointer to the current value of the secondary attribute, or nullptr if there is none or the entity does not have it.
+     ***
+     *  @fn virtual void AttributeIndexBase::remove(uint32_t index) = 0
+     *  @brief Remove an entity from the index. Does nothing if it is not indexed.
+     *  @param index Slot index of the entity.
+     ***
+     *  @fn virtual void AttributeIndexBase::clear() = 0
+     *  @brief Remove all entities from the index.
+     ***
+     *  @class HashIndex
+     *  @brief Finds all entities having an attribute equal to a given value in constant time.
+     *
+     *  Entities are kept in one list per distinct value, and removing an entity swaps the last entity of its list into its place, so updates are constant time as well regardless of how many entities share a value.
+     *  @tparam DataType Type of the attribute. Must be equality comparable and have a specialization of std::hash.
+     ***
+     *  @fn HashIndex::HashIndex(uint32_t attribute)
+     *  @brief Construct an empty index.
+     *  @param attribute Index of the indexed attribute.
+     ***
+     *  @fn const std::vector<EntityId>& HashIndex::find(const DataType& value) const
+     *  @brief Get all entities with a given value, in no particular order.
+     *  @param value Value to look for.
+     *  @return IDs of the entities. Valid until the index is next updated.
+     ***
+     *  @class SortedIndex
+     *  @brief Finds all entities having an attribute within a range of values in logarithmic time.
+     *  @tparam DataType Type of the attribute. Must be comparable using operator<.
+     ***
+     *  @fn SortedIndex::SortedIndex(uint32_t attribute)
+     *  @brief Construct an empty index.
+     *  @param attribute Index of the indexed attribute.
+     ***
+     *  @fn void SortedIndex::forEachInRange(const DataType& min, const DataType& max, Function function) const
+     *  @brief Call a function for every entity with a value between two values, including the bounds.
+     *
+     *  Entities are visited in ascending order of their value.
+     *  @tparam Function Callable with the signature void(EntityId).
+     *  @param min Lowest value to include.
+     *  @param max Highest value to include.
+     *  @param function Function to call.
+     ***/
+}
@@ -0,0 +1,125 @@
+template<class DataType>
+HashIndex<DataType>::HashIndex(uint32_t attribute) : AttributeIndexBase(attribute, typeid(DataType))
+{
+}
+
+template<class DataType>
+void HashIndex<DataType>::update(EntityId id, const void* value, const void*)
+{
+    const DataType& newValue = *static_cast<const DataType*>(value);
+    uint32_t index = getEntityIndex(id);
+
+    if(index >= mIds.size())
+    {
+        mValues.resize(index + 1);
+        mIds.resize(index + 1, ~EntityId(0));
+        mPositions.resize(index + 1);
+    }
+    else if(mIds[index] == id && mValues[index] == newValue)
+    {
+        return;
+    }
+
+    if(mIds[index] != ~EntityId(0))
+        erase(index);
+
+    std::vector<EntityId>& bucket = mBuckets[newValue];
+    mPositions[index] = static_cast<uint32_t>(bucket.size());
+    bucket.push_back(id);
+    mValues[index] = newValue;
+    mIds[index] = id;
+}
+
+template<class DataType>
+void HashIndex<DataType>::remove(uint32_t index)
+{
+    if(index < mIds.size() && mIds[index] != ~EntityId(0))
+        erase(index);
+}
+
+template<class DataType>
+void HashIndex<DataType>::clear()
+{
+    mBuckets.clear();
+    mValues.clear();
+    mIds.clear();
+    mPositions.clear();
+}
+
+template<class DataType>
+const std::vector<EntityId>& HashIndex<DataType>::find(const DataType& value) const
+{
+    auto bucket = mBuckets.find(value);
+    return bucket != mBuckets.end() ? bucket->second : mNone;
+}
+
+template<class DataType>
+void HashIndex<DataType>::erase(uint32_t index)
+{
+    auto bucket = mBuckets.find(mValues[index]);
+    FEA_ASSERT(bucket != mBuckets.end(), "Indexed value not found in hash index! Values must compare equal to themselves.");
+    std::vector<EntityId>& ids = bucket->second;
+
+    uint32_t position = mPositions[index];
+    ids[position] = ids.back();
+    mPositions[getEntityIndex(ids[position])] = position;
+    ids.pop_back();
+
+    if(ids.empty())
+        mBuckets.erase(bucket);
+
+    mIds[index] = ~EntityId(0);
+}
+
+template<class DataType>
+SortedIndex<DataType>::SortedIndex(uint32_t attribute) : AttributeIndexBase(attribute, typeid(DataType))
+{
+}
+
+template<class DataType>
+void SortedIndex<DataType>::update(EntityId id, const void* value, const void*)
+{
+    const DataType& newValue = *static_cast<const DataType*>(value);
+    uint32_t index = getEntityIndex(id);
+
+    if(index >= mIds.size())
+    {
+        mValues.resize(index + 1);
+        mIds.resize(index + 1, ~EntityId(0));
+    }
+    else if(mIds[index] == id && !(mValues[index] < newValue) && !(newValue < mValues[index]))
+    {
+        return;
+    }
+
+    remove(index);
+    mEntries.emplace(newValue, id);
+    mValues[index] = newValue;
+    mIds[index] = id;
+}
+
+template<class DataType>
+void SortedIndex<DataType>::remove(uint32_t index)
+{
+    if(index < mIds.size() && mIds[index] != ~EntityId(0))
+    {
+        mEntries.erase(std::make_pair(mValues[index], mIds[index]));
+        mIds[index] = ~EntityId(0);
+    }
+}
+
+template<class DataType>
+void SortedIndex<DataType>::clear()
+{
+    mEntries.clear();
+    mValues.clear();
+    mIds.clear();
+}
+
+template<class DataType>
+template<class Function>
+void SortedIndex<DataType>::forEachInRange(const DataType& min, const DataType& max, Function function) const
+{
+    for(auto entry = mEntries.lower_bound(std::make_pair(min, EntityId(0))); entry != mEntries.end() && !(max < entry->first); ++entry)
+        function(entry->second);
+}
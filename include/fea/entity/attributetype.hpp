@@ -0,0 +1,91 @@
+#pragma once
+#include <fea/config.hpp>
+#include <cstdint>
+#include <new>
+#include <typeindex>
+#include <type_traits>
+#include <utility>
+
+namespace fea
+{
+    struct FEA_API AttributeType
+    {
+        AttributeType(std::type_index type);
+        std::type_index mType;
+        uint32_t mSize;
+        uint32_t mAlignment;
+        bool mTriviallyCopyable;
+        void (*mConstruct)(void* destination);
+        void (*mDestroy)(void* value);
+        void (*mMove)(void* destination, void* source);
+        void (*mCopy)(void* destination, const void* source);
+        void (*mAssign)(void* destination, const void* source);
+    };
+
+    template<class DataType>
+    AttributeType makeAttributeType();
+
+    template<class DataType>
+    void setCopyFunctions(AttributeType& type, std::true_type copyable);
+    template<class DataType>
+    void setCopyFunctions(AttributeType& type, std::false_type copyable);
+
+#include <fea/entity/attributetype.inl>
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class AttributeType
+     *  @fn AttributeType makeAttributeType()
+     *  @fn setCopyFunctions
+     *@}
+     ***
+     *  @class AttributeType
+     *  @brief Type erased description of the type of an attribute.
+     *
+     *  Holds the size and alignment of the type together with functions for constructing, destroying and moving values in raw memory. This lets the EntityStorage handle memory holding attribute values without knowing their types.
+     ***
+     *  @fn AttributeType::AttributeType(std::type_index type)
+     *  @brief Construct an AttributeType for the given type, without any functions set.
+     *
+     *  Use makeAttributeType to create a complete description.
+     *  @param type The type.
+     ***
+     *  @var AttributeType::mType
+     *  @brief The described type.
+     ***
+     *  @var AttributeType::mSize
+     *  @brief Size of a value in bytes.
+     ***
+     *  @var AttributeType::mAlignment
+     *  @brief Required alignment of a value in bytes.
+     ***
+     *  @var AttributeType::mTriviallyCopyable
+     *  @brief True if values can be copied as raw bytes.
+     ***
+     *  @var AttributeType::mConstruct
+     *  @brief Value initialize a value in uninitialized memory.
+     ***
+     *  @var AttributeType::mDestroy
+     *  @brief Destroy a value, leaving the memory uninitialized.
+     ***
+     *  @var AttributeType::mMove
+     *  @brief Move construct a value into uninitialized memory from another value. The source value is left constructed.
+     ***
+     *  @var AttributeType::mCopy
+     *  @brief Copy construct a value into uninitialized memory from another value. Null if the type is not copyable.
+     ***
+     *  @var AttributeType::mAssign
+     *  @brief Copy assign a value to an already constructed value. Null if the type is not copyable.
+     ***
+     *  @fn AttributeType makeAttributeType()
+     *  @brief Create the description of a type.
+     *  @tparam DataType Type to describe. Must be default constructible.
+     *  @return The description.
+     ***
+     *  @fn void setCopyFunctions(AttributeType& type, std::true_type copyable)
+     *  @brief Used by makeAttributeType to set AttributeType::mCopy and AttributeType::mAssign for copyable types.
+     ***
+     *  @fn void setCopyFunctions(AttributeType& type, std::false_type copyable)
+     *  @brief Used by makeAttributeType to leave the copy functions unset for types which are not copyable.
+     ***/
+}
@@ -0,0 +1,40 @@
+template<class DataType>
+AttributeType makeAttributeType()
+{
+    AttributeType type(typeid(DataType));
+    type.mSize = sizeof(DataType);
+    type.mAlignment = alignof(DataType);
+    type.mTriviallyCopyable = std::is_trivially_copyable<DataType>::value;
+    type.mConstruct = [] (void* destination)
+    {
+        new (destination) DataType();
+    };
+    type.mDestroy = [] (void* value)
+    {
+        static_cast<DataType*>(value)->~DataType();
+    };
+    type.mMove = [] (void* destination, void* source)
+    {
+        new (destination) DataType(std::move(*static_cast<DataType*>(source)));
+    };
+    setCopyFunctions<DataType>(type, std::integral_constant<bool, std::is_copy_constructible<DataType>::value && std::is_copy_assignable<DataType>::value>());
+    return type;
+}
+
+template<class DataType>
+void setCopyFunctions(AttributeType& type, std::true_type)
+{
+    type.mCopy = [] (void* destination, const void* source)
+    {
+        new (destination) DataType(*static_cast<const DataType*>(source));
+    };
+    type.mAssign = [] (void* destination, const void* source)
+    {
+        *static_cast<DataType*>(destination) = *static_cast<const DataType*>(source);
+    };
+}
+
+template<class DataType>
+void setCopyFunctions(AttributeType&, std::false_type)
+{
+}
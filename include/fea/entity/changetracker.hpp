@@ -0,0 +1,99 @@
+#pragma once
+#include <fea/config.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <fea/entity/entityid.hpp>
+
+namespace fea
+{
+    class FEA_API ChangeTracker
+    {
+        public:
+            ChangeTracker(const std::vector<uint32_t>& generations);
+            void markChanged(EntityId id, uint32_t frame, bool concurrent = false);
+            bool hasChanged(EntityId id, uint32_t sinceFrame) const;
+            template<class Function>
+            void forEachChanged(uint32_t sinceFrame, Function function) const;
+            uint32_t getLogSize() const;
+            uint64_t getMarkCount() const;
+            void trim();
+            void truncate(uint32_t slotCount);
+        private:
+            struct Change
+            {
+                uint32_t mFrame;
+                EntityId mId;
+            };
+
+            bool isLatest(const Change& change) const;
+            void compact();
+            const std::vector<uint32_t>& mGenerations;
+            std::vector<uint32_t> mFrames;
+            std::vector<EntityId> mLastIds;
+            std::vector<Change> mLog;
+            uint64_t mMarks;
+            std::mutex mLogMutex;
+    };
+
+#include <fea/entity/changetracker.inl>
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class ChangeTracker
+     *@}
+     ***
+     *  @class ChangeTracker
+     *  @brief Keeps track of which entities had an attribute changed, and in which frame.
+     *
+     *  Used by the EntityStorage for attributes with change tracking enabled through EntityManager::trackChanges. Every entity slot remembers the frame of the latest change, which makes checking a single entity a constant time operation. Changes are also appended to a log ordered by frame, so the entities changed since a given frame can be visited without looking at any other entities.
+     *
+     *  An entity changed several times is logged once per frame it was changed in, and only its latest entry is visited. Entries which are no longer the latest, or belong to removed entities, are dropped when the log grows to twice the amount of entity slots, which keeps the memory bounded without ever having to discard changes manually.
+     ***
+     *  @fn ChangeTracker::ChangeTracker(const std::vector<uint32_t>& generations)
+     *  @brief Construct an empty tracker with room for all existing entity slots.
+     *  @param generations Slot generations of the EntityStorage, used to skip removed entities.
+     ***
+     *  @fn void ChangeTracker::markChanged(EntityId id, uint32_t frame, bool concurrent = false)
+     *  @brief Record that an entity changed.
+     *
+     *  When called concurrently, every thread must mark different entities, and the tracker must already have room for them. This is the case for entities which existed when the tracker was constructed, and the EntityStorage marks all later entities when they are created. The log is then appended to under a lock, which only happens the first time an entity changes in a frame, and it is not compacted until ChangeTracker::trim is called.
+     *  @param id ID of the entity.
+     *  @param frame Current frame.
+     *  @param concurrent True if other threads may be marking other entities at the same time.
+     ***
+     *  @fn bool ChangeTracker::hasChanged(EntityId id, uint32_t sinceFrame) const
+     *  @brief Check if an entity changed during or after a frame.
+     *  @param id ID of the entity.
+     *  @param sinceFrame Earliest frame to consider.
+     *  @return True if the entity exists and changed.
+     ***
+     *  @fn void ChangeTracker::forEachChanged(uint32_t sinceFrame, Function function) const
+     *  @brief Call a function with the ID of every existing entity which changed during or after a frame.
+     *
+     *  Entities are visited in the order of their latest change.
+     *  @tparam Function Callable with the signature void(EntityId).
+     *  @param sinceFrame Earliest frame to consider.
+     *  @param function Function to call.
+     ***
+     *  @fn uint32_t ChangeTracker::getLogSize() const
+     *  @brief Get the amount of entries currently in the change log, including ones which will be skipped.
+     *  @return Amount of entries.
+     ***
+     *  @fn uint64_t ChangeTracker::getMarkCount() const
+     *  @brief Get a counter which increases whenever entities are marked, including entities marked again in the same frame.
+     *
+     *  Lets users of the tracker, like an AttributeIndexBase, skip looking at the log when nothing has been marked since they last did.
+     *  @return The counter.
+     ***
+     *  @fn void ChangeTracker::trim()
+     *  @brief Finish marking done concurrently. Compacts the log if it has grown too large and increases the mark count.
+     ***
+     *  @fn void ChangeTracker::truncate(uint32_t slotCount)
+     *  @brief Forget all changes of entity slots at or beyond a slot count, and drop them from the log.
+     *
+     *  Used by the EntityStorage when reading a snapshot with fewer slots than currently exist.
+     *  @param slotCount Amount of entity slots to keep.
+     ***/
+}
@@ -0,0 +1,14 @@
+template<class Function>
+void ChangeTracker::forEachChanged(uint32_t sinceFrame, Function function) const
+{
+    auto first = std::lower_bound(mLog.begin(), mLog.end(), sinceFrame, [] (const Change& change, uint32_t frame)
+    {
+        return change.mFrame < frame;
+    });
+
+    for(auto change = first; change != mLog.end(); ++change)
+    {
+        if(isLatest(*change))
+            function(change->mId);
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <fea/config.hpp>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace fea
+{
+    class FEA_API ChunkPool
+    {
+        public:
+            static const uint32_t SlabSize = 65536;
+
+            ChunkPool();
+            ChunkPool(const ChunkPool&) = delete;
+            ChunkPool& operator=(const ChunkPool&) = delete;
+            unsigned char* allocate(uint32_t bytes);
+            void release(unsigned char* chunk, uint32_t bytes);
+            void clear();
+            uint32_t getUsedCount() const;
+            uint32_t getFreeCount() const;
+            uint64_t getReservedBytes() const;
+        private:
+            static uint32_t roundSize(uint32_t bytes);
+            std::unordered_map<uint32_t, std::vector<unsigned char*>> mFreeChunks;
+            std::vector<std::unique_ptr<unsigned char[]>> mSlabs;
+            uint32_t mUsedCount;
+            uint32_t mFreeCount;
+            uint64_t mReservedBytes;
+    };
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class ChunkPool
+     *@}
+     ***
+     *  @class ChunkPool
+     *  @brief Hands out the memory chunks of the archetypes of an EntityStorage.
+     *
+     *  Chunks are carved out of slabs of at least ChunkPool::SlabSize bytes, and released chunks are kept in a free list per chunk size to be handed out again to any archetype. Removing and creating entities, and restoring snapshots, thereby reuse the same memory rather than going through the heap for every chunk. Slabs are only freed all at once by ChunkPool::clear, so the memory held is bounded by the most chunks ever in use at the same time.
+     ***
+     *  @var ChunkPool::SlabSize
+     *  @brief Smallest amount of bytes allocated at once. Chunks larger than this get a slab of their own.
+     ***
+     *  @fn ChunkPool::ChunkPool()
+     *  @brief Construct an empty pool.
+     ***
+     *  @fn unsigned char* ChunkPool::allocate(uint32_t bytes)
+     *  @brief Get a chunk, reusing a released chunk of the same size if there is one.
+     *  @param bytes Size of the chunk. Chunks are aligned for any fundamental type.
+     *  @return Pointer to the chunk.
+     ***
+     *  @fn void ChunkPool::release(unsigned char* chunk, uint32_t bytes)
+     *  @brief Give a chunk back to the pool to be reused.
+     *  @param chunk Chunk obtained from ChunkPool::allocate.
+     *  @param bytes Size the chunk was allocated with.
+     ***
+     *  @fn void ChunkPool::clear()
+     *  @brief Free all slabs.
+     *
+     *  Assert/undefined behavior if any chunk is still in use.
+     ***
+     *  @fn uint32_t ChunkPool::getUsedCount() const
+     *  @brief Get the amount of chunks currently handed out.
+     *  @return Amount of chunks.
+     ***
+     *  @fn uint32_t ChunkPool::getFreeCount() const
+     *  @brief Get the amount of chunks waiting to be reused.
+     *  @return Amount of chunks.
+     ***
+     *  @fn uint64_t ChunkPool::getReservedBytes() const
+     *  @brief Get the total size of all slabs.
+     *  @return Size in bytes.
+     ***/
+}
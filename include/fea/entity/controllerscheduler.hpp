@@ -0,0 +1,100 @@
+#pragma once
+#include <fea/config.hpp>
+#include <atomic>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <fea/entity/entitycontroller.hpp>
+#include <fea/entity/threadpool.hpp>
+
+namespace fea
+{
+    class FEA_API ControllerScheduler
+    {
+        public:
+            ControllerScheduler(ThreadPool& threadPool);
+            void addController(EntityController& controller);
+            void addController(EntityController& controller, const std::set<std::string>& readAttributes, const std::set<std::string>& writeAttributes);
+            void removeController(EntityController& controller);
+            void entityCreated(EntityPtr entity);
+            void entityRemoved(EntityId entityId);
+            void update(float deltaTime);
+            ThreadPool& getThreadPool();
+        private:
+            struct Node
+            {
+                EntityController* mController;
+                bool mExclusive;
+                std::set<std::string> mReads;
+                std::set<std::string> mWrites;
+                uint32_t mDependencyCount;
+                std::vector<uint32_t> mDependents;
+            };
+
+            static bool conflicts(const Node& first, const Node& second);
+            void buildGraph();
+            void schedule(uint32_t node, ThreadPool::TaskGroup& group, float deltaTime);
+            ThreadPool& mThreadPool;
+            std::vector<Node> mNodes;
+            std::unique_ptr<std::atomic<uint32_t>[]> mRemaining;
+            bool mGraphDirty;
+    };
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class ControllerScheduler
+     *@}
+     ***
+     *  @class ControllerScheduler
+     *  @brief Updates EntityController instances in parallel on a ThreadPool.
+     *
+     *  Controllers are added along with the names of the attributes they read and the attributes they write. Two controllers conflict if one of them writes an attribute that the other one reads or writes. Conflicting controllers are updated in the order they were added, while controllers that do not conflict are updated at the same time on different threads. Controllers added without any attribute sets conflict with every other controller, so they always run on their own.
+     *
+     *  Controllers must not create or remove entities from within their update function when run by the scheduler, since other controllers may be accessing the EntityManager at the same time. To split the work of a single controller over several threads, iterate an EntityQuery using EntityQuery::forEachParallel with the pool returned by ControllerScheduler::getThreadPool.
+     *  @code
+     *  fea::ThreadPool pool;
+     *  fea::ControllerScheduler scheduler(pool);
+     *  scheduler.addController(physics, {"mass"}, {"position", "velocity"});
+     *  scheduler.addController(animation, {"velocity"}, {"animation_frame"});   //waits for physics since it reads velocity
+     *  scheduler.addController(ai, {"health"}, {"ai_state"});                   //runs alongside physics
+     *  scheduler.update(deltaTime);
+     *  @endcode
+     ***
+     *  @fn ControllerScheduler::ControllerScheduler(ThreadPool& threadPool)
+     *  @brief Construct a scheduler.
+     *  @param threadPool Pool to run the controllers on.
+     ***
+     *  @fn void ControllerScheduler::addController(EntityController& controller)
+     *  @brief Add a controller which may access any attribute. It will never run at the same time as any other controller.
+     *  @param controller Controller to add. Must outlive the scheduler or be removed before it is destroyed.
+     ***
+     *  @fn void ControllerScheduler::addController(EntityController& controller, const std::set<std::string>& readAttributes, const std::set<std::string>& writeAttributes)
+     *  @brief Add a controller along with the attributes it accesses.
+     *
+     *  An attribute that is written does not have to be listed as read as well.
+     *  @param controller Controller to add. Must outlive the scheduler or be removed before it is destroyed.
+     *  @param readAttributes Attributes the controller only reads.
+     *  @param writeAttributes Attributes the controller writes.
+     ***
+     *  @fn void ControllerScheduler::removeController(EntityController& controller)
+     *  @brief Remove a controller.
+     *  @param controller Controller to remove.
+     ***
+     *  @fn void ControllerScheduler::entityCreated(EntityPtr entity)
+     *  @brief Let all controllers know that an entity has been created.
+     *  @param entity Created entity.
+     ***
+     *  @fn void ControllerScheduler::entityRemoved(EntityId entityId)
+     *  @brief Let all controllers know that an entity has been removed.
+     *  @param entityId ID of the removed entity.
+     ***
+     *  @fn void ControllerScheduler::update(float deltaTime)
+     *  @brief Update all controllers, returning when all of them are done.
+     *  @param deltaTime Amount of time passed.
+     ***
+     *  @fn ThreadPool& ControllerScheduler::getThreadPool()
+     *  @brief Get the pool the controllers run on.
+     *  @return The pool.
+     ***/
+}
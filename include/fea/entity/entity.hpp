@@ -13,8 +13,16 @@ namespace fea
             template<class DataType>
             DataType& getAttribute(const std::string& attribute);
             template<class DataType>
+            const DataType& getAttribute(const AttributeHandle<DataType>& attribute) const;
+            template<class DataType>
+            DataType& getAttribute(const AttributeHandle<DataType>& attribute);
+            template<class DataType>
             void setAttribute(const std::string& attribute, DataType value) const;
+            template<class DataType>
+            void setAttribute(const AttributeHandle<DataType>& attribute, typename AttributeHandle<DataType>::Type value) const;
             bool hasAttribute(const std::string& attribute) const;
+            template<class DataType>
+            bool hasAttribute(const AttributeHandle<DataType>& attribute) const;
             EntityId getId() const;
             std::unordered_set<std::string> getAttributes() const;
         private:
@@ -59,6 +67,24 @@ namespace fea
      *  @param attribute Name of the attribute to get.
      *  @return Attribute value.
      ***
+     *  @fn const DataType& Entity::getAttribute(const AttributeHandle<DataType>& attribute) const
+     *  @brief Get the value of an attribute of the entity using a pre-resolved handle.
+     *
+     *  See AttributeHandle for more information.
+     *  Assert/undefined behavior when the entity does not have the attribute.
+     *  @tparam Type of the attribute to get.
+     *  @param attribute Handle of the attribute to get.
+     *  @return Attribute value.
+     ***
+     *  @fn DataType& Entity::getAttribute(const AttributeHandle<DataType>& attribute)
+     *  @brief Get the value of an attribute of the entity using a pre-resolved handle.
+     *
+     *  See AttributeHandle for more information.
+     *  Assert/undefined behavior when the entity does not have the attribute.
+     *  @tparam Type of the attribute to get.
+     *  @param attribute Handle of the attribute to get.
+     *  @return Attribute value.
+     ***
      *  @fn void Entity::setAttribute(const std::string& attribute, DataType value) const
      *  @brief Set the value of an attribute of the entity.
      *
@@ -67,12 +93,27 @@ namespace fea
      *  @param attribute Name of the attribute to set.
      *  @param value Value to set the attribute to.
      ***
+     *  @fn void Entity::setAttribute(const AttributeHandle<DataType>& attribute, typename AttributeHandle<DataType>::Type value) const
+     *  @brief Set the value of an attribute of the entity using a pre-resolved handle.
+     *
+     *  See AttributeHandle for more information.
+     *  Assert/undefined behavior when the entity does not have the attribute.
+     *  @tparam Type of the attribute to set.
+     *  @param attribute Handle of the attribute to set.
+     *  @param value Value to set the attribute to.
+     ***
      *  @fn bool Entity::hasAttribute(const std::string& attribute) const
      *  @brief Check if the entity has an attribute.
      *
      *  @param attribute Name of the attribute to check.
      *  @return True if the attribute exists.
      ***
+     *  @fn bool Entity::hasAttribute(const AttributeHandle<DataType>& attribute) const
+     *  @brief Check if the entity has an attribute using a pre-resolved handle.
+     *
+     *  @param attribute Handle of the attribute to check.
+     *  @return True if the attribute exists.
+     ***
      *  @fn EntityId Entity::getId() const
      *  @brief Get the ID of an entity.
      *  @return The ID.
@@ -1,19 +1,45 @@
 template<class DataType>
 const DataType& Entity::getAttribute(const std::string& attribute) const
 {
-    FEA_ASSERT(!mEntityManager.findEntity(mId).expired(), "Trying to set the attribute '" + attribute + "' on entity ID '" + std::to_string(mId) + "' which has previously been deleted!");
+    FEA_ASSERT(mEntityManager.isValid(mId), "Trying to set the attribute '" + attribute + "' on entity ID '" + std::to_string(mId) + "' which has previously been deleted!");
     return mEntityManager.getAttribute<DataType>(mId, attribute);
 }
 
 template<class DataType>
 DataType& Entity::getAttribute(const std::string& attribute)
 {
-    FEA_ASSERT(!mEntityManager.findEntity(mId).expired(), "Trying to set the attribute '" + attribute + "' on entity ID '" + std::to_string(mId) + "' which has previously been deleted!");
+    FEA_ASSERT(mEntityManager.isValid(mId), "Trying to set the attribute '" + attribute + "' on entity ID '" + std::to_string(mId) + "' which has previously been deleted!");
     return mEntityManager.getAttribute<DataType>(mId, attribute);
 }
 
+template<class DataType>
+const DataType& Entity::getAttribute(const AttributeHandle<DataType>& attribute) const
+{
+    FEA_ASSERT(mEntityManager.isValid(mId), "Trying to get an attribute on entity ID '" + std::to_string(mId) + "' which has previously been deleted!");
+    return mEntityManager.getAttribute(mId, attribute);
+}
+
+template<class DataType>
+DataType& Entity::getAttribute(const AttributeHandle<DataType>& attribute)
+{
+    FEA_ASSERT(mEntityManager.isValid(mId), "Trying to get an attribute on entity ID '" + std::to_string(mId) + "' which has previously been deleted!");
+    return mEntityManager.getAttribute(mId, attribute);
+}
+
 template<class DataType>
 void Entity::setAttribute(const std::string& attribute, DataType value) const
 {
     mEntityManager.setAttribute<DataType>(mId, attribute, std::move(value));
 }
+
+template<class DataType>
+void Entity::setAttribute(const AttributeHandle<DataType>& attribute, typename AttributeHandle<DataType>::Type value) const
+{
+    mEntityManager.setAttribute(mId, attribute, std::move(value));
+}
+
+template<class DataType>
+bool Entity::hasAttribute(const AttributeHandle<DataType>& attribute) const
+{
+    return mEntityManager.hasAttribute(mId, attribute);
+}
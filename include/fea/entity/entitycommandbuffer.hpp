@@ -0,0 +1,139 @@
+#pragma once
+#include <fea/config.hpp>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fea/entity/entitymanager.hpp>
+
+namespace fea
+{
+    class ControllerScheduler;
+
+    class FEA_API EntityCommandBuffer
+    {
+        public:
+            EntityCommandBuffer(EntityManager& entityManager);
+            EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+            EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+            void createEntity(const std::set<std::string>& attributes, std::function<void(EntityHandle)> initializer = nullptr);
+            void removeEntity(EntityId id);
+            template<class DataType>
+            void setAttribute(EntityId id, const std::string& attribute, DataType value);
+            template<class DataType>
+            void setAttribute(EntityId id, const AttributeHandle<DataType>& attribute, typename AttributeHandle<DataType>::Type value);
+            std::vector<EntityId> playback();
+            std::vector<EntityId> playback(ControllerScheduler& scheduler);
+            bool isEmpty() const;
+            void clear();
+        private:
+            enum CommandType { CREATE, REMOVE, SET };
+
+            struct Command
+            {
+                CommandType mType;
+                EntityId mId;
+                std::set<std::string> mAttributes;
+                std::function<void(EntityHandle)> mFunction;
+            };
+
+            struct Queue
+            {
+                std::thread::id mThread;
+                std::vector<Command> mCommands;
+            };
+
+            template<class DataType, class Attribute>
+            struct Setter
+            {
+                Attribute mAttribute;
+                DataType mValue;
+                void operator()(EntityHandle entity);
+            };
+
+            Queue& getQueue();
+            std::vector<EntityId> playback(ControllerScheduler* scheduler);
+            EntityManager& mEntityManager;
+            uint64_t mInstance;
+            mutable std::mutex mQueuesMutex;
+            std::vector<std::unique_ptr<Queue>> mQueues;
+    };
+
+#include <fea/entity/entitycommandbuffer.inl>
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class EntityCommandBuffer
+     *@}
+     ***
+     *  @class EntityCommandBuffer
+     *  @brief Records entity creations, removals and attribute changes to be carried out later.
+     *
+     *  Entities must not be created or removed while iterating over entities, and not at all while controllers run in parallel. The command buffer lets such code record what it wants to do and apply everything at a later point using EntityCommandBuffer::playback, when nothing else is accessing the EntityManager.
+     *
+     *  Every thread records into its own command list, so several threads may record into the same buffer at the same time without contending for a lock. Playback must happen on a single thread while no thread is recording, which includes initializers run during playback. The commands of every thread are played back in the order they were recorded, thread by thread. Removals are carried out last, in one batch.
+     *
+     *  Commands referring to entities which no longer exist when the buffer is played back are ignored, as are duplicate removals of the same entity.
+     *  @code
+     *  fea::EntityCommandBuffer commands(entityManager);
+     *
+     *  bullets.forEachParallel(pool, [&] (fea::EntityId id, float& lifeTime)
+     *  {
+     *      if(lifeTime <= 0.0f)
+     *          commands.removeEntity(id);
+     *  });
+     *
+     *  commands.playback(scheduler);
+     *  @endcode
+     ***
+     *  @fn EntityCommandBuffer::EntityCommandBuffer(EntityManager& entityManager)
+     *  @brief Construct a command buffer operating on the given EntityManager.
+     *  @param entityManager EntityManager to apply the commands to.
+     ***
+     *  @fn void EntityCommandBuffer::createEntity(const std::set<std::string>& attributes, std::function<void(EntityHandle)> initializer = nullptr)
+     *  @brief Record the creation of an entity.
+     *  @param attributes Attributes of the entity.
+     *  @param initializer Optional function called with the created entity during playback, for instance to set its attributes.
+     ***
+     *  @fn void EntityCommandBuffer::removeEntity(EntityId id)
+     *  @brief Record the removal of an entity.
+     *  @param id ID of the entity to remove.
+     ***
+     *  @fn void EntityCommandBuffer::setAttribute(EntityId id, const std::string& attribute, DataType value)
+     *  @brief Record setting an attribute of an entity.
+     *
+     *  The name is resolved during playback. Assert/undefined behavior at playback if the attribute does not exist or has a different type.
+     *  @tparam Type of the attribute.
+     *  @param id ID of the entity.
+     *  @param attribute Name of the attribute.
+     *  @param value Value to set.
+     ***
+     *  @fn void EntityCommandBuffer::setAttribute(EntityId id, const AttributeHandle<DataType>& attribute, typename AttributeHandle<DataType>::Type value)
+     *  @brief Record setting an attribute of an entity using a pre-resolved handle.
+     *  @tparam Type of the attribute.
+     *  @param id ID of the entity.
+     *  @param attribute Handle of the attribute.
+     *  @param value Value to set.
+     ***
+     *  @fn std::vector<EntityId> EntityCommandBuffer::playback()
+     *  @brief Apply all recorded commands to the EntityManager and clear the buffer.
+     *  @return IDs of the created entities which still exist after playback.
+     ***
+     *  @fn std::vector<EntityId> EntityCommandBuffer::playback(ControllerScheduler& scheduler)
+     *  @brief Apply all recorded commands and notify the controllers of a scheduler.
+     *
+     *  Once all creations and attribute changes are done, the controllers are told about every created entity, and then about every entity about to be removed. The removals happen after the notifications so that the controllers can still access the removed entities.
+     *  @param scheduler Scheduler whose controllers to notify.
+     *  @return IDs of the created entities which still exist after playback.
+     ***
+     *  @fn bool EntityCommandBuffer::isEmpty() const
+     *  @brief Check if there are no recorded commands.
+     *  @return True if the buffer is empty.
+     ***
+     *  @fn void EntityCommandBuffer::clear()
+     *  @brief Discard all recorded commands.
+     ***/
+}
@@ -0,0 +1,17 @@
+template<class DataType>
+void EntityCommandBuffer::setAttribute(EntityId id, const std::string& attribute, DataType value)
+{
+    getQueue().mCommands.push_back(Command{SET, id, {}, Setter<DataType, std::string>{attribute, std::move(value)}});
+}
+
+template<class DataType>
+void EntityCommandBuffer::setAttribute(EntityId id, const AttributeHandle<DataType>& attribute, typename AttributeHandle<DataType>::Type value)
+{
+    getQueue().mCommands.push_back(Command{SET, id, {}, Setter<DataType, AttributeHandle<DataType>>{attribute, std::move(value)}});
+}
+
+template<class DataType, class Attribute>
+void EntityCommandBuffer::Setter<DataType, Attribute>::operator()(EntityHandle entity)
+{
+    entity.setAttribute<DataType>(mAttribute, std::move(mValue));
+}
@@ -33,6 +33,10 @@ namespace fea
      *  Controllers are created by inheriting this class and then specializing their behavior. 
      *
      *  When entities are created and removed, all components must be notified using the EntityController::entityCreated and EntityController::entityRemoved functions.
+     *
+     *  Controllers which only care about entities having a certain set of attributes can use an EntityQuery from EntityManager::query in their update function instead. The query keeps its matched entities up to date by itself, so such controllers do not need to keep any entities.
+     *
+     *  To update several controllers in parallel, add them to a ControllerScheduler along with the attributes they read and write.
      ***
      *  @fn void EntityController::entityCreated(EntityPtr entity)
      *  @brief Let the component know that an entity has been created.
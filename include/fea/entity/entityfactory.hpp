@@ -8,8 +8,7 @@
 namespace fea
 {
     using Parameters     = std::vector<std::string>;
-    using Setter         = std::function<void(EntityPtr&)>;
-    using Parser         = std::function<Setter(const std::string&)>;
+    using Parser         = std::function<void(const std::string&, void*)>;
     using Registrator   = std::function<Parser(const std::string&)>;
 
     class FEA_API EntityFactory
@@ -23,24 +22,36 @@ namespace fea
             void registerAttribute(const std::string& attribute, const std::string& dataType);
             void addTemplate(const std::string& name, const EntityTemplate& entityTemplate);
             bool hasTemplate(const std::string& name) const;
+            void setCopyOnWrite(const std::string& name, bool enabled);
             WeakEntityPtr instantiate(const std::string& name);
+            std::vector<EntityHandle> instantiate(const std::string& name, uint32_t count);
+            std::vector<EntityHandle> instantiate(const std::string& name, uint32_t count, const std::function<void(EntityHandle, uint32_t)>& initializer);
+            bool saveTemplateCache(const std::vector<std::string>& templates, uint64_t sourceHash, std::vector<uint8_t>& data) const;
+            bool loadTemplateCache(const std::vector<uint8_t>& data, uint64_t sourceHash);
         private:
             Parameters splitByDelimeter(const std::string& in, char delimeter) const;
 
             struct Prototype
             {
-                struct Value
+                struct DefaultValue
                 {
-                    bool operator<(const Value& other) const;
-                    std::string mKey;
-                    Setter mSetter;
+                    uint32_t mAttribute;
+                    uint32_t mOffset;
+                    AttributeType mType;
                 };
 
-                std::set<std::string> attributes;
-                std::set<Value> values;
+                Prototype();
+                ~Prototype();
+                std::vector<uint32_t> mAttributes;
+                std::vector<DefaultValue> mDefaults;
+                std::unique_ptr<unsigned char[]> mImage;
+                bool mCopyOnWrite;
             };
 
-            std::unordered_map<std::string, Prototype> mPrototypes;
+            void applyDefaults(const std::shared_ptr<Prototype>& prototype, const std::vector<EntityId>& ids);
+
+            //shared so that entities sharing default values keep them alive
+            std::unordered_map<std::string, std::shared_ptr<Prototype>> mPrototypes;
             std::unordered_map<std::string, Parser> mParsers;
             std::unordered_map<std::string, Registrator> mRegistrators;
 
@@ -65,6 +76,8 @@ namespace fea
      *
      *  This template describing a turtle entity has five attributes: health, position, velocity, maxvelocity and collisiontype. All of the attributes have to be registered at the entity manager. The numerical values next to the attribute names are their default values. These are the values that the attributes of a created turtle entity will attain. To give default values to an attribute, a parser function must be provided to the data type registration.
      *
+     *  When a template is added, it is compiled into a list of attribute indices and an image holding its already parsed default values, with everything inherited from parent templates resolved. Instantiating a template only copies the values of the image into the storage of the new entities.
+     *
      *  This class needs a reference to an EntityManager instance.
      ***
      *  @fn EntityFactory::EntityFactory(EntityManager& entityManager)
@@ -123,6 +136,20 @@ namespace fea
      *  @param name Name of the template.
      *  @return True if it exists.
      ***
+     *  @fn void EntityFactory::setCopyOnWrite(const std::string& name, bool enabled)
+     *  @brief Let entities instantiated from a template share its default values until they are written.
+     *
+     *  Normally every instantiated entity gets its own copy of every default value. With copy-on-write enabled, entities instead refer to the values held by the template, and only get their own copy the first time the value is accessed in a way which allows writing it: through a non-const getter, a setter, which replaces the value without copying it, or any EntityQuery covering the attribute. Reading through a const EntityManager or Entity keeps the value shared. For large numbers of entities whose default values are mostly never changed, such as long names or lists of tags, this saves both the time and the memory spent copying them.
+     *  @code
+     *  factory.setCopyOnWrite("citizen", true);
+     *  factory.instantiate("citizen", 100000);
+     *  @endcode
+     *  Only values of types which are not trivially copyable are shared, since copying the others is as cheap as sharing them. Values of attributes used by a query are always copied as well. Templates used by existing entities stay alive until EntityManager::clear is called or a snapshot is loaded, even if the factory is destroyed. The setting is not inherited and not stored in template caches.
+     *
+     *  Assert/undefined behavior if the template does not exist.
+     *  @param name Name of the template.
+     *  @param enabled True to share default values.
+     ***
      *  @fn WeakEntityPtr EntityFactory::instantiate(const std::string& name)
      *  @brief Create an Entity from the given template.
      *  
@@ -132,5 +159,53 @@ namespace fea
      *
      *  @param name The name of the template to instantiate.
      *  @return A pointer to the created Entity.
+     ***
+     *  @fn std::vector<EntityHandle> EntityFactory::instantiate(const std::string& name, uint32_t count)
+     *  @brief Create several entities from the given template.
+     *
+     *  Storage for all entities is reserved at once and the default values are applied one attribute at a time, which is much faster than instantiating the entities one by one. No Entity instances are allocated.
+     *
+     *  Assert/undefined behavior if the template given does not exist.
+     *  @param name The name of the template to instantiate.
+     *  @param count Amount of entities to create.
+     *  @return Handles to the created entities.
+     ***
+     *  @fn std::vector<EntityHandle> EntityFactory::instantiate(const std::string& name, uint32_t count, const std::function<void(EntityHandle, uint32_t)>& initializer)
+     *  @brief Create several entities from the given template and initialize each of them.
+     *
+     *  Works like EntityFactory::instantiate(const std::string& name, uint32_t count), but also calls the initializer for every created entity after the default values have been applied. The initializer is given the entity and its index in the batch.
+     *  @code
+     *  factory.instantiate("tile", width * height, [&] (fea::EntityHandle tile, uint32_t index)
+     *  {
+     *      tile.setAttribute(position, glm::vec2(index % width, index / width));
+     *  });
+     *  @endcode
+     *
+     *  Assert/undefined behavior if the template given does not exist.
+     *  @param name The name of the template to instantiate.
+     *  @param count Amount of entities to create.
+     *  @param initializer Function to call for every created entity.
+     *  @return Handles to the created entities.
+     ***
+     *  @fn bool EntityFactory::saveTemplateCache(const std::vector<std::string>& templates, uint64_t sourceHash, std::vector<uint8_t>& data) const
+     *  @brief Write compiled templates to a binary cache which can be loaded using EntityFactory::loadTemplateCache instead of adding the templates again.
+     *
+     *  The cache holds the attributes and the already parsed default values of every template, with inheritance resolved. Values of trivially copyable types are stored as they are, and other types are written with the serializer set using EntityManager::setSerializer. The cache is tagged with a hash of the sources the templates were made from, which is what decides if it can be used later. JsonEntityLoader::loadEntityTemplates can take care of all of this given a cache path.
+     *
+     *  Assert/undefined behavior if any of the templates does not exist.
+     *  @param templates Names of the templates to write.
+     *  @param sourceHash Hash of the source of the templates.
+     *  @param data Buffer to write the cache to. Any previous content is replaced.
+     *  @return False if a default value has a type which is neither trivially copyable nor has a serializer, in which case the templates can not be cached.
+     ***
+     *  @fn bool EntityFactory::loadTemplateCache(const std::vector<uint8_t>& data, uint64_t sourceHash)
+     *  @brief Add all templates from a cache written by EntityFactory::saveTemplateCache, without parsing any default values.
+     *
+     *  Nothing is added if the cache was written by another version, for another source hash, is truncated or refers to attributes which are not registered with the same type and size. The templates should then be added from their source and the cache rewritten.
+     *
+     *  Assert/undefined behavior if a template in the cache has already been added.
+     *  @param data Cache to load.
+     *  @param sourceHash Hash of the current source of the templates.
+     *  @return True if the templates were added.
      ***/
 }
@@ -7,15 +7,10 @@ void EntityFactory::addDataType(const std::string& dataTypeName, Function parser
     mRegistrators[dataTypeName] = [this, parser](const std::string& attributeName)->Parser
     {
         mManager.registerAttribute<Type>(attributeName);
-        //Make parser
-        return [this, parser, attributeName](const std::string& params)->Setter
+        //Make parser which constructs the value in the default value image of a prototype
+        return [this, parser](const std::string& params, void* destination)
         {
-            auto value = parser(splitByDelimeter(params, ','));
-            //make setter.
-            return [attributeName, value](EntityPtr& entity)
-            {
-                entity->setAttribute<Type>(attributeName, value);
-            };
+            new (destination) Type(parser(splitByDelimeter(params, ',')));
         };
     };
 }
@@ -29,12 +24,10 @@ void EntityFactory::addDataType(const std::string& dataTypeName)
     {
         mManager.registerAttribute<Type>(attributeName);
         //Make parser
-        return [attributeName](const std::string& params)->Setter
+        return [attributeName](const std::string& params, void* destination)
         {
             FEA_ASSERT(1 == 0, "Trying to register a template where a default value has been added to the attribute '" + attributeName + "' which doesn't have a parser function!");
-            return [](EntityPtr& entity)
-            {
-            };
+            new (destination) Type();
         };
     };
 }
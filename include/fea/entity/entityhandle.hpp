@@ -0,0 +1,135 @@
+#pragma once
+#include <fea/config.hpp>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <fea/entity/entityid.hpp>
+#include <fea/entity/attributehandle.hpp>
+
+namespace fea
+{
+    class EntityManager;
+
+    class FEA_API EntityHandle
+    {
+        public:
+            EntityHandle();
+            EntityHandle(EntityId id, EntityManager& entityManager);
+            template<class DataType>
+            DataType& getAttribute(const std::string& attribute) const;
+            template<class DataType>
+            DataType& getAttribute(const AttributeHandle<DataType>& attribute) const;
+            template<class DataType>
+            void setAttribute(const std::string& attribute, DataType value) const;
+            template<class DataType>
+            void setAttribute(const AttributeHandle<DataType>& attribute, typename AttributeHandle<DataType>::Type value) const;
+            bool hasAttribute(const std::string& attribute) const;
+            template<class DataType>
+            bool hasAttribute(const AttributeHandle<DataType>& attribute) const;
+            EntityId getId() const;
+            EntityManager* getEntityManager() const;
+            bool isValid() const;
+            std::unordered_set<std::string> getAttributes() const;
+            bool operator==(const EntityHandle& other) const;
+            bool operator!=(const EntityHandle& other) const;
+        private:
+            EntityId mId;
+            EntityManager* mEntityManager;
+    };
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class EntityHandle
+     *@}
+     ***
+     *  @class EntityHandle
+     *  @brief Lightweight reference to an entity.
+     *
+     *  An EntityHandle is only an EntityId together with a pointer to the EntityManager owning the entity. It is trivially copyable and involves no reference counting, so it can be stored and passed around freely, for instance in large containers of controllers. Unlike with Entity instances obtained through a WeakEntityPtr, no object is allocated per entity.
+     *
+     *  A handle does not keep its entity alive. Use EntityHandle::isValid to check if the entity still exists, which is a constant time check. Handles to removed entities stay invalid even if the entity ID slot is reused.
+     *
+     *  Handles are obtained from EntityManager::createHandle, EntityManager::getHandle and EntityManager::getHandles.
+     ***
+     *  @fn EntityHandle::EntityHandle()
+     *  @brief Construct an invalid handle.
+     ***
+     *  @fn EntityHandle::EntityHandle(EntityId id, EntityManager& entityManager)
+     *  @brief Construct a handle to an entity.
+     *  @param id ID of the entity.
+     *  @param entityManager EntityManager owning the entity.
+     ***
+     *  @fn DataType& EntityHandle::getAttribute(const std::string& attribute) const
+     *  @brief Get the value of an attribute of the entity.
+     *
+     *  Assert/undefined behavior when the entity does not exist, the attribute does not exist or the wrong template argument is provided.
+     *  @tparam Type of the attribute to get.
+     *  @param attribute Name of the attribute to get.
+     *  @return Attribute value.
+     ***
+     *  @fn DataType& EntityHandle::getAttribute(const AttributeHandle<DataType>& attribute) const
+     *  @brief Get the value of an attribute of the entity using a pre-resolved handle.
+     *
+     *  Assert/undefined behavior when the entity does not exist or does not have the attribute.
+     *  @tparam Type of the attribute to get.
+     *  @param attribute Handle of the attribute to get.
+     *  @return Attribute value.
+     ***
+     *  @fn void EntityHandle::setAttribute(const std::string& attribute, DataType value) const
+     *  @brief Set the value of an attribute of the entity.
+     *
+     *  Assert/undefined behavior when the entity does not exist, the attribute does not exist or the wrong template argument is provided.
+     *  @tparam Type of the attribute to set.
+     *  @param attribute Name of the attribute to set.
+     *  @param value Value to set the attribute to.
+     ***
+     *  @fn void EntityHandle::setAttribute(const AttributeHandle<DataType>& attribute, typename AttributeHandle<DataType>::Type value) const
+     *  @brief Set the value of an attribute of the entity using a pre-resolved handle.
+     *
+     *  Assert/undefined behavior when the entity does not exist or does not have the attribute.
+     *  @tparam Type of the attribute to set.
+     *  @param attribute Handle of the attribute to set.
+     *  @param value Value to set the attribute to.
+     ***
+     *  @fn bool EntityHandle::hasAttribute(const std::string& attribute) const
+     *  @brief Check if the entity has an attribute.
+     *  @param attribute Name of the attribute to check.
+     *  @return True if the attribute exists.
+     ***
+     *  @fn bool EntityHandle::hasAttribute(const AttributeHandle<DataType>& attribute) const
+     *  @brief Check if the entity has an attribute using a pre-resolved handle.
+     *  @param attribute Handle of the attribute to check.
+     *  @return True if the attribute exists.
+     ***
+     *  @fn EntityId EntityHandle::getId() const
+     *  @brief Get the ID of the entity.
+     *  @return The ID.
+     ***
+     *  @fn EntityManager* EntityHandle::getEntityManager() const
+     *  @brief Get the EntityManager owning the entity.
+     *  @return Pointer to the EntityManager. Null for handles constructed with the default constructor.
+     ***
+     *  @fn bool EntityHandle::isValid() const
+     *  @brief Check if the entity still exists.
+     *  @return True if the entity exists.
+     ***
+     *  @fn std::unordered_set<std::string> EntityHandle::getAttributes() const
+     *  @brief Get a set containing all the attributes of the entity.
+     *
+     *  Assert/undefined behavior if the entity does not exist.
+     *  @return Set with attributes.
+     ***
+     *  @fn bool EntityHandle::operator==(const EntityHandle& other) const
+     *  @brief Check if two handles refer to the same entity.
+     *  @param other Handle to compare with.
+     *  @return True if they are equal.
+     ***
+     *  @fn bool EntityHandle::operator!=(const EntityHandle& other) const
+     *  @brief Check if two handles refer to different entities.
+     *  @param other Handle to compare with.
+     *  @return True if they are not equal.
+     ***/
+}
+
+//the templates need the full EntityManager, so entityhandle.inl is included at the end of entitymanager.hpp
+#include <fea/entity/entitymanager.hpp>
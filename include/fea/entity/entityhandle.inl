@@ -0,0 +1,29 @@
+template<class DataType>
+DataType& EntityHandle::getAttribute(const std::string& attribute) const
+{
+    return mEntityManager->getAttribute<DataType>(mId, attribute);
+}
+
+template<class DataType>
+DataType& EntityHandle::getAttribute(const AttributeHandle<DataType>& attribute) const
+{
+    return mEntityManager->getAttribute(mId, attribute);
+}
+
+template<class DataType>
+void EntityHandle::setAttribute(const std::string& attribute, DataType value) const
+{
+    mEntityManager->setAttribute<DataType>(mId, attribute, std::move(value));
+}
+
+template<class DataType>
+void EntityHandle::setAttribute(const AttributeHandle<DataType>& attribute, typename AttributeHandle<DataType>::Type value) const
+{
+    mEntityManager->setAttribute(mId, attribute, std::move(value));
+}
+
+template<class DataType>
+bool EntityHandle::hasAttribute(const AttributeHandle<DataType>& attribute) const
+{
+    return mEntityManager->hasAttribute(mId, attribute);
+}
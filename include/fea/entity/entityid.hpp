@@ -0,0 +1,53 @@
+#pragma once
+#include <fea/config.hpp>
+#include <cstdint>
+
+namespace fea
+{
+    using EntityId = uint64_t;
+
+    inline EntityId makeEntityId(uint32_t index, uint32_t generation)
+    {
+        return static_cast<EntityId>(index) | (static_cast<EntityId>(generation) << 32);
+    }
+
+    inline uint32_t getEntityIndex(EntityId id)
+    {
+        return static_cast<uint32_t>(id & 0xffffffffu);
+    }
+
+    inline uint32_t getEntityGeneration(EntityId id)
+    {
+        return static_cast<uint32_t>(id >> 32);
+    }
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @typedef EntityId
+     *  @fn makeEntityId
+     *  @fn getEntityIndex
+     *  @fn getEntityGeneration
+     *@}
+     ***
+     *  @typedef EntityId
+     *  @brief Identifies an entity.
+     *
+     *  The lower 32 bits hold the index of the slot the entity occupies in the EntityStorage, and the upper 32 bits hold the generation of that slot. Slots are reused after an entity is removed, but the generation is increased every time, so an ID kept around after its entity was removed never refers to a newer entity occupying the same slot.
+     ***
+     *  @fn EntityId makeEntityId(uint32_t index, uint32_t generation)
+     *  @brief Compose an entity ID.
+     *  @param index Slot index.
+     *  @param generation Slot generation.
+     *  @return Entity ID.
+     ***
+     *  @fn uint32_t getEntityIndex(EntityId id)
+     *  @brief Get the slot index of an entity ID.
+     *  @param id Entity ID.
+     *  @return Slot index.
+     ***
+     *  @fn uint32_t getEntityGeneration(EntityId id)
+     *  @brief Get the slot generation of an entity ID.
+     *  @param id Entity ID.
+     *  @return Slot generation.
+     ***/
+}
@@ -1,6 +1,9 @@
 #pragma once
 #include <fea/config.hpp>
+#include <fea/entity/entityid.hpp>
 #include <fea/entity/entitystorage.hpp>
+#include <fea/entity/entityhandle.hpp>
+#include <fea/entity/spatialindex.hpp>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -14,34 +17,92 @@ namespace fea
 
     using EntityPtr = std::shared_ptr<Entity>;
     using WeakEntityPtr = std::weak_ptr<Entity>;
-    using EntityId = int32_t;
     using EntitySet = std::set<WeakEntityPtr, std::owner_less<WeakEntityPtr>>;
 
     class FEA_API EntityManager
     {
         public:
+            EntityManager(EntityStorage::StorageLayout layout = EntityStorage::COLUMNS);
             WeakEntityPtr createEntity(const std::set<std::string>& attributes);
+            EntityHandle createHandle(const std::set<std::string>& attributes);
+            std::vector<EntityHandle> createHandles(const std::set<std::string>& attributes, uint32_t count);
+            std::vector<EntityHandle> clone(EntityId id, uint32_t count);
             WeakEntityPtr findEntity(EntityId id) const;
+            EntityHandle getHandle(EntityId id);
             void removeEntity(const EntityId id);
+            void removeEntities(const std::vector<EntityId>& ids);
+            bool isValid(const EntityId id) const;
             template<class DataType>
             const DataType& getAttribute(const EntityId id, const std::string& attribute) const;
             template<class DataType>
             DataType& getAttribute(const EntityId id, const std::string& attribute);
             template<class DataType>
+            const DataType& getAttribute(const EntityId id, const AttributeHandle<DataType>& attribute) const;
+            template<class DataType>
+            DataType& getAttribute(const EntityId id, const AttributeHandle<DataType>& attribute);
+            template<class DataType>
             void setAttribute(const EntityId id, const std::string& attribute, DataType attributeData);
+            template<class DataType>
+            void setAttribute(const EntityId id, const AttributeHandle<DataType>& attribute, typename AttributeHandle<DataType>::Type attributeData);
             bool hasAttribute(const EntityId id, const std::string& attribute) const;
             template<class DataType>
-            void registerAttribute(const std::string& attributeName);
+            bool hasAttribute(const EntityId id, const AttributeHandle<DataType>& attribute) const;
+            template<class DataType>
+            AttributeHandle<DataType> registerAttribute(const std::string& attributeName);
+            template<class DataType>
+            AttributeHandle<DataType> getAttributeHandle(const std::string& attributeName) const;
             bool attributeIsValid(const std::string& attributeName) const;
+            template<class... DataTypes>
+            EntityQuery<DataTypes...>& query(const AttributeHandle<DataTypes>&... attributes);
+            template<class... DataTypes>
+            EntityQuery<DataTypes...>& query(const std::array<std::string, sizeof...(DataTypes)>& attributes);
+            void sortColumns(const EntityQueryBase& query);
             EntitySet getAll() const;
+            const std::vector<EntityHandle>& getHandles() const;
             void removeAll();
             void clear();
             std::unordered_set<std::string> getAttributes(EntityId id) const;
+            void beginConcurrentAccess();
+            void endConcurrentAccess();
+            bool isConcurrentAccess() const;
+            void trackChanges(const std::string& attribute);
+            void markChanged(EntityId id, const std::string& attribute);
+            bool hasChanged(EntityId id, const std::string& attribute, uint32_t sinceFrame) const;
+            template<class Function>
+            void forEachChanged(const std::string& attribute, uint32_t sinceFrame, Function function) const;
+            uint32_t getFrame() const;
+            void nextFrame();
+            template<class DataType>
+            void addHashIndex(const std::string& attribute);
+            template<class DataType>
+            void addSortedIndex(const std::string& attribute);
+            template<class DataType>
+            const std::vector<EntityId>& findByValue(const std::string& attribute, const DataType& value);
+            template<class DataType, class Function>
+            void forEachInRange(const std::string& attribute, const DataType& min, const DataType& max, Function function);
+            template<class TreeType, class VectorType>
+            void addSpatialIndex(const std::string& position, const std::string& size, const VectorType& bounds);
+            template<class TreeType, class VectorType>
+            std::vector<EntityHandle> findInArea(const std::string& position, const VectorType& start, const VectorType& end);
+            template<class TreeType, class VectorType>
+            std::vector<EntityHandle> findAt(const std::string& position, const VectorType& point);
+            template<class DataType>
+            void setSerializer(std::function<void(const DataType&, SnapshotWriter&)> write, std::function<void(DataType&, SnapshotReader&)> read);
+            void saveSnapshot(std::vector<uint8_t>& data) const;
+            bool loadSnapshot(const std::vector<uint8_t>& data);
+            void getStats(EntityStats& stats) const;
         private:
-            std::unordered_map<EntityId, EntityPtr> mEntities;
+            void trackEntity(EntityId id);
+            std::vector<EntityHandle> trackEntities(const std::vector<EntityId>& ids);
+            void releaseEntity(EntityId id);
+            mutable std::vector<EntityPtr> mEntities;
+            std::vector<EntityHandle> mHandles;
+            std::vector<uint32_t> mHandleIndices;
             EntityStorage mStorage;
+        friend class EntityFactory;
     };
 #include <fea/entity/entitymanager.inl>
+#include <fea/entity/entityhandle.inl>
     /** @addtogroup EntitySystem
      *@{
      *  @class EntityManager
@@ -50,8 +111,6 @@ namespace fea
      *  
      *  @typedef WeakEntityPtr
      *
-     *  @typedef EntityId
-     *
      *  @typedef EntitySet
      *@}
      ***
@@ -61,9 +120,6 @@ namespace fea
      *  @typedef WeakEntityPtr
      *  @brief A weak pointer to an Entity instance.
      *
-     *  @typedef EntityId
-     *  @brief The ID of an Entity instance. This is a normal 32 bit unsigned integer.
-     *
      *  @typedef EntitySet
      *  @brief An std::set containing a number of entities represented with WeakEntityPtr instances.
      *
@@ -77,6 +133,28 @@ namespace fea
      *  Prior to creating any Entity instances, attributes must be registered. Attributes are values belonging to entities. Some examples of attributes includes "health", "weight", "position" and "velocity". The type for the attribute is remembered by the entity manager.  Registration is done using EntityManager::registerAttribute.
      *
      *  After attributes have been registered, entities can be created. Entities have zero or more of registered attributes and they can be set for individual entities.
+     *
+     *  The EntityManager is not synchronized, but it supports being accessed from several threads at once in a limited way. Between EntityManager::beginConcurrentAccess and EntityManager::endConcurrentAccess, any number of threads may get and set attribute values and look up entities, as long as no two threads access the same entity where at least one of them writes. No locks are taken for this; attribute names are only looked up in tables which do not change during the section, and attribute handles skip the lookup entirely. Structural changes, meaning creating or removing entities, registering attributes, creating new queries and the like, are not allowed during the section and assert. Record them using an EntityCommandBuffer and play it back after the section has ended.
+     *  @code
+     *  entityManager.beginConcurrentAccess();
+     *
+     *  agents.forEachParallel(pool, [&] (fea::EntityId id, AiState& state)
+     *  {
+     *      state = evaluate(entityManager.getAttribute(id, positionHandle));
+     *
+     *      if(state.done)
+     *          commands.removeEntity(id);
+     *  });
+     *
+     *  entityManager.endConcurrentAccess();
+     *  commands.playback();
+     *  @endcode
+     ***
+     *  @fn EntityManager::EntityManager(EntityStorage::StorageLayout layout = EntityStorage::COLUMNS)
+     *  @brief Construct an EntityManager.
+     *
+     *  The layout decides how attribute values are stored. See EntityStorage::StorageLayout for the trade-offs. Since the attribute set of an entity never changes after creation, entities never have to move between archetypes when using EntityStorage::ARCHETYPES.
+     *  @param layout Storage layout to use.
      ***
      *  @fn WeakEntityPtr EntityManager::createEntity(const std::set<std::string>& attributes)
      *  @brief Create an Entity with the given attributes.
@@ -85,11 +163,43 @@ namespace fea
      *  @param attributes The names of the attributes the entity should have.
      *  @return A pointer to the created Entity.
      ***
+     *  @fn EntityHandle EntityManager::createHandle(const std::set<std::string>& attributes)
+     *  @brief Create an entity with the given attributes and get an EntityHandle to it.
+     *
+     *  Works like EntityManager::createEntity but does not allocate any Entity instance. An Entity instance is only created if the entity is later accessed through EntityManager::findEntity or EntityManager::getAll.
+     *  @param attributes The names of the attributes the entity should have.
+     *  @return Handle to the created entity.
+     ***
+     *  @fn std::vector<EntityHandle> EntityManager::createHandles(const std::set<std::string>& attributes, uint32_t count)
+     *  @brief Create several entities with the same attributes.
+     *
+     *  The attribute names are only looked up once and storage for all entities is reserved up front, which makes this a lot faster than creating the entities one by one.
+     *  @param attributes The names of the attributes the entities should have.
+     *  @param count Amount of entities to create.
+     *  @return Handles to the created entities.
+     ***
+     *  @fn std::vector<EntityHandle> EntityManager::clone(EntityId id, uint32_t count)
+     *  @brief Create several copies of an existing entity.
+     *
+     *  The copies have the same attributes as the original, and all values are copied one attribute at a time without any name lookups. Values the original shares with its template, as described at EntityFactory::setCopyOnWrite, stay shared by the copies. This is much faster than instantiating a template and then setting the attributes of every entity, for instance when spawning many entities like one which was set up at run time.
+     *
+     *  Assert/undefined behavior if the entity does not exist or has an attribute whose type is not copyable.
+     *  @param id ID of the entity to copy.
+     *  @param count Amount of copies to create.
+     *  @return Handles to the copies.
+     ***
      *  @fn WeakEntityPtr EntityManager::findEntity(EntityId id) const
      *  @brief Search for an entity with a given ID.
      *  @param id ID of the entity to find.
      *  @return Pointer to the entity. Will be null if no such entity exists.
      ***
+     *  @fn EntityHandle EntityManager::getHandle(EntityId id)
+     *  @brief Get an EntityHandle to an entity.
+     *
+     *  Assert/undefined behavior when the entity does not exist.
+     *  @param id ID of the entity.
+     *  @return Handle to the entity.
+     ***
      *  @fn void EntityManager::removeEntity(const EntityId id)
      *  @brief Remove an Entity. 
      *
@@ -98,6 +208,20 @@ namespace fea
      *
      *  @param id ID of the Entity to remove.
      ***
+     *  @fn void EntityManager::removeEntities(const std::vector<EntityId>& ids)
+     *  @brief Remove several entities at once.
+     *
+     *  Equivalent to calling EntityManager::removeEntity for every ID, but the storage is updated one attribute at a time rather than one entity at a time.
+     *  Assert/undefined behavior when an entity does not exist or is listed more than once.
+     *  @param ids IDs of the entities to remove.
+     ***
+     *  @fn bool EntityManager::isValid(const EntityId id) const
+     *  @brief Check if an entity ID refers to an existing entity.
+     *
+     *  This is a constant time array comparison. An ID of a removed entity stays invalid even when its slot is reused by a newly created entity, so IDs can safely be stored across frames and checked before use.
+     *  @param id ID to check.
+     *  @return True if the entity exists.
+     ***
      *  @fn const DataType& EntityManager::getAttribute(const EntityId id, const std::string& attribute) const
      *  @brief Retrieve the value of an attribute of a selected Entity. 
      *  
@@ -109,11 +233,33 @@ namespace fea
      *  @fn DataType& EntityManager::getAttribute(const EntityId id, const std::string& attribute)
      *  @brief Retrieve the value of an attribute of a selected Entity. 
      *  
+     *  The returned reference is only valid until the next time an Entity is created or removed.
+     *
      *  Assert/undefined behavior when the attribute does not exist or the wrong template argument is provided or the entity does not exist.
      *  @tparam DataType of the attribute to get.
      *  @param attribute Name of the attribute to get.
      *  @param id ID of the Entity to get the attribute from.
      ***
+     *  @fn const DataType& EntityManager::getAttribute(const EntityId id, const AttributeHandle<DataType>& attribute) const
+     *  @brief Retrieve the value of an attribute of a selected Entity using a pre-resolved handle.
+     *  
+     *  This does not hash the attribute name and the type is given by the handle. See AttributeHandle for more information.
+     *
+     *  Assert/undefined behavior when the entity does not exist or does not have the attribute.
+     *  @tparam DataType of the attribute to get.
+     *  @param attribute Handle of the attribute to get.
+     *  @param id ID of the Entity to get the attribute from.
+     ***
+     *  @fn DataType& EntityManager::getAttribute(const EntityId id, const AttributeHandle<DataType>& attribute)
+     *  @brief Retrieve the value of an attribute of a selected Entity using a pre-resolved handle.
+     *  
+     *  This does not hash the attribute name and the type is given by the handle. See AttributeHandle for more information. The returned reference is only valid until the next time an Entity is created or removed.
+     *
+     *  Assert/undefined behavior when the entity does not exist or does not have the attribute.
+     *  @tparam DataType of the attribute to get.
+     *  @param attribute Handle of the attribute to get.
+     *  @param id ID of the Entity to get the attribute from.
+     ***
      *  @fn void EntityManager::setAttribute(const EntityId id, const std::string& attribute, DataType attributeData)
      *  @brief Set the value of an attribute of a selected Entity. 
      *  
@@ -123,6 +269,17 @@ namespace fea
      *  @param attribute Name of the attribute to set.
      *  @param attributeData Value to set the attribute to.
      ***
+     *  @fn void EntityManager::setAttribute(const EntityId id, const AttributeHandle<DataType>& attribute, typename AttributeHandle<DataType>::Type attributeData)
+     *  @brief Set the value of an attribute of a selected Entity using a pre-resolved handle.
+     *  
+     *  The type of the value is given by the handle, so literals are converted to the attribute type.
+     *
+     *  Assert/undefined behavior when the entity does not exist or does not have the attribute.
+     *  @tparam DataType of the attribute to set.
+     *  @param id ID of the Entity to set the attribute of.
+     *  @param attribute Handle of the attribute to set.
+     *  @param attributeData Value to set the attribute to.
+     ***
      *  @fn bool EntityManager::hasAttribute(const EntityId id, const std::string& attribute) const
      *  @brief Check if an attribute exists for a specific Entity.
      *
@@ -131,7 +288,15 @@ namespace fea
      *  @param attribute Name of the attribute to check for.
      *  @return True if the attribute exists, otherwise false.
      ***
-     *  @fn void EntityManager::registerAttribute(const std::string& attribute)
+     *  @fn bool EntityManager::hasAttribute(const EntityId id, const AttributeHandle<DataType>& attribute) const
+     *  @brief Check if an attribute exists for a specific Entity using a pre-resolved handle.
+     *
+     *  Assert/undefined behavior when the entity does not exist.
+     *  @param id Entity to check an attribute for.
+     *  @param attribute Handle of the attribute to check for.
+     *  @return True if the attribute exists, otherwise false.
+     ***
+     *  @fn AttributeHandle<DataType> EntityManager::registerAttribute(const std::string& attribute)
      *  @brief Register an attribute.
      *  
      *  For an Entity to be able to have a certain attribute, the attribute needs to be registered, otherwise it can't be stored by the EntityManager. This only needs to be done once for every attribute. 
@@ -140,19 +305,66 @@ namespace fea
      *  @code
      *  entityManager.registerAttribute<int32_t>("Health points");
      *  @endcode
+     *  Attribute values are stored packed in one column per attribute, and every attribute of a newly created Entity is value initialized. Therefore DataType must be default constructible.
+     *
      *  Assert/undefined behavior when the attribute is already registered.
      *  @tparam DataType Type of the attribute.
      *  @param attribute Name of the attribute to register.
+     *  @return Handle that can be used to access the attribute without name lookups.
+     ***
+     *  @fn AttributeHandle<DataType> EntityManager::getAttributeHandle(const std::string& attributeName) const
+     *  @brief Look up the handle of a registered attribute.
+     *
+     *  Assert/undefined behavior when the attribute is not registered or is not of the given type.
+     *  @tparam DataType Type of the attribute.
+     *  @param attributeName Name of the attribute.
+     *  @return Handle to the attribute.
      ***
      *  @fn bool EntityManager::attributeIsValid(const std::string& attributeName) const
      *  @brief Check if an attribute has been registered.
      *  @param attributeName Name of the attribute.
      *  @return True if valid.
      ***
+     *  @fn EntityQuery<DataTypes...>& EntityManager::query(const AttributeHandle<DataTypes>&... attributes)
+     *  @brief Get a query matching all entities which have the given attributes.
+     *
+     *  The query is created the first time it is asked for and is then kept up to date by the EntityManager when entities are created and removed. Asking for the same attributes again returns the same query. See EntityQuery for more information.
+     *
+     *  The returned reference stays valid until EntityManager::clear is called.
+     *  @tparam DataTypes Types of the attributes. Inferred from the handles.
+     *  @param attributes Handles of the attributes to match.
+     *  @return The query.
+     ***
+     *  @fn EntityQuery<DataTypes...>& EntityManager::query(const std::array<std::string, sizeof...(DataTypes)>& attributes)
+     *  @brief Get a query matching all entities which have the given attributes.
+     *
+     *  Same as the handle version, but looks up the attributes by name.
+     *  @code
+     *  auto& moving = entityManager.query<glm::vec2, glm::vec2>({"position", "velocity"});
+     *  @endcode
+     *  Assert/undefined behavior when an attribute is not registered or the types do not match the attributes.
+     *  @tparam DataTypes Types of the attributes, in the same order as the names.
+     *  @param attributes Names of the attributes to match.
+     *  @return The query.
+     ***
+     *  @fn void EntityManager::sortColumns(const EntityQueryBase& query)
+     *  @brief Reorder the stored values of the attributes of a query so that the query visits them in the order they are stored in.
+     *
+     *  In the EntityStorage::COLUMNS layout, every attribute is packed in its own column, and a query only walks the columns contiguously while they store the matched entities first and in the same order as the query. That holds when all entities having one of the attributes are created with all of them, but creating entities with only some of the attributes, or removing entities, lets the orders drift apart, after which the query looks up every value separately. Sorting moves the matched entities to the start of each column in the order of the query. It takes time linear in the amount of matched entities and is meant to be done once in a while, like after loading a level. When several queries share an attribute, only the last one sorted is lined up with the shared column. Does nothing in the EntityStorage::ARCHETYPES layout, where entities are always grouped by their attributes.
+     *
+     *  Must not be called during concurrent access, and invalidates references to the values of the attributes.
+     *  @param query Query to line the columns up with.
+     ***
      *  @fn EntitySet EntityManager::getAll() const
      *  @brief Retrieve an EntitySet filled with all entities currently managed by the EntityManager.
      *  @return All entities in a set.
      ***
+     *  @fn const std::vector<EntityHandle>& EntityManager::getHandles() const
+     *  @brief Access handles to all entities currently managed by the EntityManager.
+     *
+     *  The handles are kept in a packed array which is updated as entities are created and removed, so unlike EntityManager::getAll, this does not build anything. The order of the handles is not stable, and the array must not be iterated while creating or removing entities.
+     *  @return All entity handles.
+     ***
      *  @fn void EntityManager::removeAll()
      *  @brief Remove all Entity instances managed by the EntityManager, leaving all pointers to them invalid.
      ***
@@ -165,5 +377,202 @@ namespace fea
      *  Assert/undefined behavior if the entity does not exist.
      *  @param id Id of the entity to get attributes for.
      *  @return Set with attributes.
+     ***
+     *  @fn void EntityManager::beginConcurrentAccess()
+     *  @brief Start a section where several threads may access attribute values of different entities at the same time.
+     *
+     *  See the class description for what is allowed. Sections may be nested, and the section lasts until every call has been matched by a call to EntityManager::endConcurrentAccess. Must be called before the other threads start accessing the manager, for instance before running a ControllerScheduler or EntityQuery::forEachParallel.
+     ***
+     *  @fn void EntityManager::endConcurrentAccess()
+     *  @brief End a section started by EntityManager::beginConcurrentAccess. Must be called after the other threads are done accessing the manager.
+     ***
+     *  @fn bool EntityManager::isConcurrentAccess() const
+     *  @brief Check if a concurrent access section is active.
+     *  @return True if one is.
+     ***
+     *  @fn void EntityManager::trackChanges(const std::string& attribute)
+     *  @brief Start keeping track of which entities have an attribute changed.
+     *
+     *  Change tracking is opt-in per attribute. Once enabled, an entity counts as changed in the current frame when it is created with the attribute, and whenever the attribute is accessed through a non-const getter or set using a setter, since a non-const reference may be written through. This makes it possible for systems that mirror attribute values elsewhere, like rendering or spatial indexing, to visit only the entities changed since they last ran, using EntityManager::forEachChanged.
+     *
+     *  Values written through EntityQuery::forEach or EntityQuery::forEachParallel are not noticed, since the queries give out references to every value. Use EntityManager::markChanged for those. Changes may be recorded during concurrent access, but EntityManager::hasChanged and EntityManager::forEachChanged must not be used until it has ended.
+     *  @code
+     *  entityManager.trackChanges("position");
+     *  ...
+     *  entityManager.forEachChanged("position", mLastSync, [&] (fea::EntityId id)
+     *  {
+     *      mSprites[id].setPosition(entityManager.getAttribute<glm::vec2>(id, "position"));
+     *  });
+     *
+     *  //the reads above count as changes in the current frame, so start after it next time
+     *  mLastSync = entityManager.getFrame() + 1;
+     *  entityManager.nextFrame();
+     *  @endcode
+     *  Assert/undefined behavior if the attribute does not exist.
+     *  @param attribute Name of the attribute.
+     ***
+     *  @fn void EntityManager::markChanged(EntityId id, const std::string& attribute)
+     *  @brief Record a change to an attribute of an entity in the current frame, for changes made without going through the EntityManager. Does nothing if changes to the attribute are not tracked.
+     *
+     *  Assert/undefined behavior if the entity or the attribute does not exist.
+     *  @param id ID of the entity.
+     *  @param attribute Name of the attribute.
+     ***
+     *  @fn bool EntityManager::hasChanged(EntityId id, const std::string& attribute, uint32_t sinceFrame) const
+     *  @brief Check if an attribute of an entity has changed during or after a frame.
+     *
+     *  Assert/undefined behavior if changes to the attribute are not tracked.
+     *  @param id ID of the entity.
+     *  @param attribute Name of the attribute.
+     *  @param sinceFrame Earliest frame to consider.
+     *  @return True if the entity exists and the attribute changed.
+     ***
+     *  @fn void EntityManager::forEachChanged(const std::string& attribute, uint32_t sinceFrame, Function function) const
+     *  @brief Call a function for every existing entity which had an attribute changed during or after a frame.
+     *
+     *  The cost depends only on the amount of changes, not on the amount of entities. Every entity is visited once, even if it changed several times. Entities must not be created or removed from within the function.
+     *
+     *  Assert/undefined behavior if changes to the attribute are not tracked.
+     *  @tparam Function Callable with the signature void(EntityId).
+     *  @param attribute Name of the attribute.
+     *  @param sinceFrame Earliest frame to consider.
+     *  @param function Function to call.
+     ***
+     *  @fn uint32_t EntityManager::getFrame() const
+     *  @brief Get the frame changes are currently recorded in. Starts at zero.
+     *  @return The frame.
+     ***
+     *  @fn void EntityManager::nextFrame()
+     *  @brief Advance to the next frame. Typically called once per game loop iteration.
+     ***
+     *  @fn void EntityManager::addHashIndex(const std::string& attribute)
+     *  @brief Add an index for finding entities by the exact value of an attribute using EntityManager::findByValue.
+     *
+     *  Indexes turn lookups like finding the entity with a given name, or all entities of a given team, from a scan over all entities into a constant time lookup. The index is filled with the existing entities when added, and changes tracking of the attribute is enabled so that it can be kept up to date. Changed entities are re-indexed the next time the index is used, so writes cost nothing extra until a lookup happens.
+     *
+     *  Assert/undefined behavior if the attribute does not exist, is of another type or already has a hash index.
+     *  @tparam DataType Type of the attribute. Must be equality comparable and have a specialization of std::hash.
+     *  @param attribute Name of the attribute.
+     ***
+     *  @fn void EntityManager::addSortedIndex(const std::string& attribute)
+     *  @brief Add an index for finding entities with an attribute within a range of values using EntityManager::forEachInRange.
+     *
+     *  Works like EntityManager::addHashIndex, but keeps the entities sorted by value, making range lookups logarithmic in the amount of entities.
+     *
+     *  Assert/undefined behavior if the attribute does not exist, is of another type or already has a sorted index.
+     *  @tparam DataType Type of the attribute. Must be comparable using operator<.
+     *  @param attribute Name of the attribute.
+     ***
+     *  @fn const std::vector<EntityId>& EntityManager::findByValue(const std::string& attribute, const DataType& value)
+     *  @brief Get all entities whose attribute equals a value, using a hash index.
+     *  @code
+     *  entityManager.addHashIndex<int32_t>("team");
+     *  ...
+     *  for(fea::EntityId id : entityManager.findByValue<int32_t>("team", 3))
+     *      ...
+     *  @endcode
+     *  Assert/undefined behavior if the attribute has no hash index.
+     *  @tparam DataType Type of the attribute.
+     *  @param attribute Name of the attribute.
+     *  @param value Value to look for.
+     *  @return IDs of the entities, in no particular order. Valid until the index is next used or an entity is removed.
+     ***
+     *  @fn void EntityManager::forEachInRange(const std::string& attribute, const DataType& min, const DataType& max, Function function)
+     *  @brief Call a function for every entity whose attribute lies between two values, including the bounds, using a sorted index.
+     *
+     *  Entities are visited in ascending order of their value and must not be created or removed from within the function. Assert/undefined behavior if the attribute has no sorted index.
+     *  @tparam DataType Type of the attribute.
+     *  @tparam Function Callable with the signature void(EntityId).
+     *  @param attribute Name of the attribute.
+     *  @param min Lowest value to include.
+     *  @param max Highest value to include.
+     *  @param function Function to call.
+     ***
+     *  @fn void EntityManager::addSpatialIndex(const std::string& position, const std::string& size, const VectorType& bounds)
+     *  @brief Keep the entities having a position and a size attribute in a LooseNTree, for finding entities by area using EntityManager::findInArea and EntityManager::findAt.
+     *
+     *  This replaces keeping a tree in sync with the entities by hand. Changes to the position or size of entities, made in any way, are applied to the tree in one batch when it is next queried, and removed entities are taken out of the tree right away. The position is the center of the entity and the size its full extent.
+     *  @code
+     *  using Tree = fea::QuadTree<8, false>;
+     *  entityManager.addSpatialIndex<Tree, glm::vec2>("position", "size", glm::vec2(1024.0f, 1024.0f));
+     *  ...
+     *  for(fea::EntityHandle hit : entityManager.findInArea<Tree, glm::vec2>("position", glm::vec2(0.0f, 0.0f), glm::vec2(64.0f, 64.0f)))
+     *      ...
+     *  @endcode
+     *  Assert/undefined behavior if the attributes do not exist, are not both of the given type, if the position attribute already has a spatial index of that kind, or if any position is outside of the bounds or any size is zero or less.
+     *  @tparam TreeType LooseNTree to use, such as QuadTree<8, false>.
+     *  @tparam VectorType Type of the attributes. Must have one float coordinate per dimension of the tree accessible using operator[].
+     *  @param position Name of the position attribute.
+     *  @param size Name of the size attribute.
+     *  @param bounds Size of the tree. Positions range from zero to this.
+     ***
+     *  @fn std::vector<EntityHandle> EntityManager::findInArea(const std::string& position, const VectorType& start, const VectorType& end)
+     *  @brief Get all entities overlapping a box, using a spatial index.
+     *
+     *  The possible overlaps found in the tree are checked against the actual positions and sizes, so only entities really overlapping the box, or touching its edges, are returned. Assert/undefined behavior if the attribute has no spatial index with the given tree and vector type.
+     *  @tparam TreeType Tree type given when adding the index.
+     *  @tparam VectorType Type of the attributes.
+     *  @param position Name of the position attribute.
+     *  @param start Lowest corner of the box.
+     *  @param end Highest corner of the box.
+     *  @return Handles to the entities, in no particular order.
+     ***
+     *  @fn std::vector<EntityHandle> EntityManager::findAt(const std::string& position, const VectorType& point)
+     *  @brief Get all entities overlapping a point, using a spatial index. See EntityManager::findInArea.
+     *  @tparam TreeType Tree type given when adding the index.
+     *  @tparam VectorType Type of the attributes.
+     *  @param position Name of the position attribute.
+     *  @param point Point to check.
+     *  @return Handles to the entities, in no particular order.
+     ***
+     *  @fn void EntityManager::setSerializer(std::function<void(const DataType&, SnapshotWriter&)> write, std::function<void(DataType&, SnapshotReader&)> read)
+     *  @brief Set how attribute values of a type are written to and read from snapshots.
+     *
+     *  Trivially copyable types are stored as raw bytes and need no serializer, and std::string has one set by default. Every other attribute type has to be given a serializer before EntityManager::saveSnapshot is used. A serializer can also be set for a trivially copyable type, for instance to leave out pointers, and is then used instead of copying the bytes.
+     *  @code
+     *  entityManager.setSerializer<std::vector<int32_t>>([] (const std::vector<int32_t>& value, fea::SnapshotWriter& writer)
+     *  {
+     *      writer.write(static_cast<uint32_t>(value.size()));
+     *      writer.write(value.data(), static_cast<uint32_t>(value.size() * sizeof(int32_t)));
+     *  },
+     *  [] (std::vector<int32_t>& value, fea::SnapshotReader& reader)
+     *  {
+     *      value.resize(reader.read<uint32_t>());
+     *      reader.read(value.data(), static_cast<uint32_t>(value.size() * sizeof(int32_t)));
+     *  });
+     *  @endcode
+     *  @tparam DataType Type to set the serializer for.
+     *  @param write Function writing a value.
+     *  @param read Function reading into a default constructed value.
+     ***
+     *  @fn void EntityManager::saveSnapshot(std::vector<uint8_t>& data) const
+     *  @brief Write the state of all entities to a compact binary snapshot.
+     *
+     *  The snapshot holds the values of every attribute stored column by column, along with the entity IDs, so that it can be restored exactly using EntityManager::loadSnapshot. The attributes are identified by name, so the manager restoring the snapshot needs the same attributes registered, but not necessarily in the same order or using the same storage layout.
+     *
+     *  The contents of the buffer are replaced. Reusing the same buffer for every snapshot avoids allocations once it has grown big enough, which suits saving the state every frame for rollback.
+     *  @param data Buffer to write the snapshot to.
+     ***
+     *  @fn bool EntityManager::loadSnapshot(const std::vector<uint8_t>& data)
+     *  @brief Replace all entities with the ones stored in a snapshot.
+     *
+     *  Every entity gets back the ID it had when the snapshot was taken, and entities created afterwards are given the same IDs as they were the first time, as long as the same entities are created and removed in the same order. Entity instances and handles of entities not in the snapshot become invalid. Entity instances of restored entities are recreated, so previously obtained WeakEntityPtr instances expire. Registered attributes and queries are kept.
+     *
+     *  Snapshots are often read from files, so the data is checked before anything is replaced. If it is truncated, corrupt, of another snapshot version, or contains an attribute which is not registered or is registered with a type of a different size, nothing is loaded and all entities are left as they were.
+     *  @param data Snapshot written by EntityManager::saveSnapshot.
+     *  @return True if the snapshot was loaded.
+     ***
+     *  @fn void EntityManager::getStats(EntityStats& stats) const
+     *  @brief Get how many entities exist and how much memory the entity storage takes up, per attribute and in total.
+     *
+     *  Meant to be called every frame, for instance to show a debug overlay or to find out how much capacity to reserve up front. The cost grows with the amount of attributes and archetypes but not with the amount of entities, and reusing the same EntityStats instance avoids allocating once it has been filled in.
+     *  @code
+     *  entityManager.getStats(mStats);
+     *
+     *  for(const fea::AttributeStats& attribute : mStats.mAttributes)
+     *      overlay.print(attribute.mName + ": " + std::to_string(attribute.mCount) + " entities, " + std::to_string(attribute.mReservedBytes / 1024) + " KiB");
+     *  @endcode
+     *  Memory that attribute values allocate themselves, like the contents of strings, is not included.
+     *  @param stats Statistics to fill in. Any previous content is replaced.
      ***/
 }
@@ -1,28 +1,137 @@
 template<class DataType>
 const DataType& EntityManager::getAttribute(const EntityId id, const std::string& attribute) const
 {
-    FEA_ASSERT(mEntities.find(id) != mEntities.end(), "Trying to get the attribute '" + attribute + "' on entity entity ID '" + std::to_string(id) + "' but such an entity doesn't exist!");
+    FEA_ASSERT(isValid(id), "Trying to get the attribute '" + attribute + "' on entity entity ID '" + std::to_string(id) + "' but such an entity doesn't exist!");
 
-    return mStorage.getData<DataType>(id, attribute);
+    return mStorage.getData<DataType>(getEntityIndex(id), attribute);
 }
 
 template<class DataType>
 DataType& EntityManager::getAttribute(const EntityId id, const std::string& attribute)
 {
-    FEA_ASSERT(mEntities.find(id) != mEntities.end(), "Trying to get the attribute '" + attribute + "' on entity entity ID '" + std::to_string(id) + "' but such an entity doesn't exist!");
+    FEA_ASSERT(isValid(id), "Trying to get the attribute '" + attribute + "' on entity entity ID '" + std::to_string(id) + "' but such an entity doesn't exist!");
 
-    return mStorage.getData<DataType>(id, attribute);
+    return mStorage.getData<DataType>(getEntityIndex(id), attribute);
+}
+
+template<class DataType>
+const DataType& EntityManager::getAttribute(const EntityId id, const AttributeHandle<DataType>& attribute) const
+{
+    FEA_ASSERT(isValid(id), "Trying to get an attribute on entity entity ID '" + std::to_string(id) + "' but such an entity doesn't exist!");
+
+    return mStorage.getData(getEntityIndex(id), attribute);
+}
+
+template<class DataType>
+DataType& EntityManager::getAttribute(const EntityId id, const AttributeHandle<DataType>& attribute)
+{
+    FEA_ASSERT(isValid(id), "Trying to get an attribute on entity entity ID '" + std::to_string(id) + "' but such an entity doesn't exist!");
+
+    return mStorage.getData(getEntityIndex(id), attribute);
 }
 
     template<class DataType>
 void EntityManager::setAttribute(const EntityId id, const std::string& attribute, DataType attributeData)
 {
-    FEA_ASSERT(mEntities.find(id) != mEntities.end(), "Trying to get the attribute '" + attribute + "' on entity entity ID '" + std::to_string(id) + "' but such an entity doesn't exist!");
-    mStorage.setData(id, attribute, std::move(attributeData));
+    FEA_ASSERT(isValid(id), "Trying to get the attribute '" + attribute + "' on entity entity ID '" + std::to_string(id) + "' but such an entity doesn't exist!");
+    mStorage.setData(getEntityIndex(id), attribute, std::move(attributeData));
+}
+
+    template<class DataType>
+void EntityManager::setAttribute(const EntityId id, const AttributeHandle<DataType>& attribute, typename AttributeHandle<DataType>::Type attributeData)
+{
+    FEA_ASSERT(isValid(id), "Trying to set an attribute on entity entity ID '" + std::to_string(id) + "' but such an entity doesn't exist!");
+    mStorage.setData(getEntityIndex(id), attribute, std::move(attributeData));
 }
 
     template<class DataType>
-void EntityManager::registerAttribute(const std::string& attribute)
+bool EntityManager::hasAttribute(const EntityId id, const AttributeHandle<DataType>& attribute) const
+{
+    FEA_ASSERT(isValid(id), "Trying to check if entity ID '" + std::to_string(id) + "' has an attribute but that entity doesn't exist!");
+    return mStorage.hasData(getEntityIndex(id), attribute);
+}
+
+    template<class DataType>
+AttributeHandle<DataType> EntityManager::registerAttribute(const std::string& attribute)
+{
+    return mStorage.registerAttribute<DataType>(attribute);
+}
+
+    template<class DataType>
+AttributeHandle<DataType> EntityManager::getAttributeHandle(const std::string& attribute) const
+{
+    return mStorage.getAttributeHandle<DataType>(attribute);
+}
+
+    template<class... DataTypes>
+EntityQuery<DataTypes...>& EntityManager::query(const AttributeHandle<DataTypes>&... attributes)
+{
+    return mStorage.query(attributes...);
+}
+
+    template<class... DataTypes>
+EntityQuery<DataTypes...>& EntityManager::query(const std::array<std::string, sizeof...(DataTypes)>& attributes)
+{
+    return mStorage.query<DataTypes...>(attributes);
+}
+
+    template<class DataType>
+void EntityManager::setSerializer(std::function<void(const DataType&, SnapshotWriter&)> write, std::function<void(DataType&, SnapshotReader&)> read)
+{
+    mStorage.setSerializer<DataType>(std::move(write), std::move(read));
+}
+
+    template<class Function>
+void EntityManager::forEachChanged(const std::string& attribute, uint32_t sinceFrame, Function function) const
+{
+    mStorage.getChangeTracker(mStorage.getAttributeIndex(attribute)).forEachChanged(sinceFrame, function);
+}
+
+    template<class DataType>
+void EntityManager::addHashIndex(const std::string& attribute)
+{
+    mStorage.addIndex<HashIndex<DataType>>(mStorage.getAttributeIndex(attribute));
+}
+
+    template<class DataType>
+void EntityManager::addSortedIndex(const std::string& attribute)
+{
+    mStorage.addIndex<SortedIndex<DataType>>(mStorage.getAttributeIndex(attribute));
+}
+
+    template<class DataType>
+const std::vector<EntityId>& EntityManager::findByValue(const std::string& attribute, const DataType& value)
+{
+    return mStorage.getIndex<HashIndex<DataType>>(mStorage.getAttributeIndex(attribute)).find(value);
+}
+
+    template<class DataType, class Function>
+void EntityManager::forEachInRange(const std::string& attribute, const DataType& min, const DataType& max, Function function)
+{
+    mStorage.getIndex<SortedIndex<DataType>>(mStorage.getAttributeIndex(attribute)).forEachInRange(min, max, function);
+}
+
+    template<class TreeType, class VectorType>
+void EntityManager::addSpatialIndex(const std::string& position, const std::string& size, const VectorType& bounds)
+{
+    mStorage.addIndex<SpatialIndex<TreeType, VectorType>>(mStorage.getAttributeIndex(position), mStorage.getAttributeIndex(size), bounds);
+}
+
+    template<class TreeType, class VectorType>
+std::vector<EntityHandle> EntityManager::findInArea(const std::string& position, const VectorType& start, const VectorType& end)
+{
+    std::vector<EntityHandle> result;
+
+    mStorage.getIndex<SpatialIndex<TreeType, VectorType>>(mStorage.getAttributeIndex(position)).forEachInArea(start, end, [&] (EntityId id)
+    {
+        result.emplace_back(id, *this);
+    });
+
+    return result;
+}
+
+    template<class TreeType, class VectorType>
+std::vector<EntityHandle> EntityManager::findAt(const std::string& position, const VectorType& point)
 {
-    mStorage.registerAttribute<DataType>(attribute);
+    return findInArea<TreeType, VectorType>(position, point, point);
 }
@@ -0,0 +1,140 @@
+#pragma once
+#include <fea/config.hpp>
+#include <algorithm>
+#include <tuple>
+#include <vector>
+#include <fea/entity/entityid.hpp>
+#include <fea/entity/attributecolumn.hpp>
+#include <fea/entity/archetype.hpp>
+#include <fea/entity/threadpool.hpp>
+
+namespace fea
+{
+    template<uint32_t... Indices>
+    struct IndexSequence
+    {
+    };
+
+    template<uint32_t Size, uint32_t... Indices>
+    struct MakeIndexSequence : MakeIndexSequence<Size - 1, Size - 1, Indices...>
+    {
+    };
+
+    template<uint32_t... Indices>
+    struct MakeIndexSequence<0, Indices...>
+    {
+        using Type = IndexSequence<Indices...>;
+    };
+
+    class FEA_API EntityQueryBase
+    {
+        public:
+            EntityQueryBase(const std::vector<uint32_t>& attributes, const std::vector<AttributeColumnBase*>& columns, const std::vector<uint32_t>& generations);
+            virtual ~EntityQueryBase();
+            bool has(EntityId id) const;
+            uint32_t size() const;
+        protected:
+            bool matches(uint32_t id) const;
+            uint32_t getPackedEnd(uint32_t begin, uint32_t end) const;
+            void entityCreated(uint32_t id);
+            void entityRemoved(uint32_t id);
+            void archetypeCreated(Archetype& archetype);
+            std::vector<uint32_t> mAttributes;
+            std::vector<AttributeColumnBase*> mColumns;
+            std::vector<Archetype*> mArchetypes;
+            const std::vector<uint32_t>& mGenerations;
+            SparseSet mMatches;
+        friend class EntityStorage;
+    };
+
+    template<class... DataTypes>
+    class EntityQuery : public EntityQueryBase
+    {
+        static_assert(sizeof...(DataTypes) > 0, "An entity query needs at least one attribute");
+        public:
+            EntityQuery(const std::vector<uint32_t>& attributes, const std::vector<AttributeColumnBase*>& columns, const std::vector<uint32_t>& generations);
+            template<class Function>
+            void forEach(Function function);
+            template<class Function>
+            void forEachParallel(ThreadPool& threadPool, Function function, uint32_t grainSize = 1024);
+        private:
+            template<class Function, uint32_t... Indices>
+            void forEachInArchetypes(Function& function, IndexSequence<Indices...>);
+            template<class Function, uint32_t... Indices>
+            void forEachInRange(Function& function, uint32_t begin, uint32_t end, IndexSequence<Indices...>);
+            template<class Function, uint32_t... Indices>
+            void forEachInChunk(Function& function, Archetype& archetype, uint32_t chunk, IndexSequence<Indices...>);
+    };
+
+#include <fea/entity/entityquery.inl>
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class EntityQueryBase
+     *  @class EntityQuery
+     *@}
+     ***
+     *  @class EntityQueryBase
+     *  @brief Type erased base of EntityQuery.
+     *
+     *  In the EntityStorage::COLUMNS layout, the query keeps the set of entities which have all the attributes of the query. The set is updated by the EntityStorage whenever entities are created or removed, so it never has to be rebuilt. As long as the matched entities are stored in the same order at the start of every column, which EntityStorage::sortColumns ensures, the query walks the packed values directly instead of looking every value up. In the EntityStorage::ARCHETYPES layout, the query instead keeps the list of archetypes containing all the attributes, which only changes when a new archetype is created.
+     ***
+     *  @fn EntityQueryBase::EntityQueryBase(const std::vector<uint32_t>& attributes, const std::vector<AttributeColumnBase*>& columns, const std::vector<uint32_t>& generations)
+     *  @brief Construct a query matching entities having all of the given attributes.
+     *
+     *  Entities already existing in the columns are matched on construction. If no columns are given, the query works on archetypes which have to be supplied by the EntityStorage. Queries are not meant to be constructed manually, but retrieved using EntityManager::query.
+     *  @param attributes Indices of the attributes to match.
+     *  @param columns Columns of the attributes to match, or nothing when the storage uses archetypes.
+     *  @param generations Slot generations of the EntityStorage, used to give out complete entity IDs.
+     ***
+     *  @fn virtual EntityQueryBase::~EntityQueryBase()
+     *  @brief Destructor.
+     ***
+     *  @fn bool EntityQueryBase::has(EntityId id) const
+     *  @brief Check if an entity is matched by the query.
+     *  @param id ID of the entity.
+     *  @return True if the entity has all the attributes of the query.
+     ***
+     *  @fn uint32_t EntityQueryBase::size() const
+     *  @brief Get the amount of matched entities.
+     *  @return Amount of entities.
+     ***
+     *  @class EntityQuery
+     *  @brief A cached list of all entities which have a given set of attributes.
+     *
+     *  Queries are retrieved using EntityManager::query and are owned by the EntityManager. Asking for the same attributes twice returns the same query. The matched entities are kept up to date as entities are created and removed, so iterating a query costs nothing more than visiting the matched entities.
+     *  @code
+     *  fea::EntityQuery<glm::vec2, glm::vec2>& moving = entityManager.query<glm::vec2, glm::vec2>({"position", "velocity"});
+     *
+     *  moving.forEach([&] (fea::EntityId id, glm::vec2& position, glm::vec2& velocity)
+     *  {
+     *      position += velocity * deltaTime;
+     *  });
+     *  @endcode
+     *  @tparam DataTypes Types of the attributes of the query.
+     ***
+     *  @fn EntityQuery::EntityQuery(const std::vector<uint32_t>& attributes, const std::vector<AttributeColumnBase*>& columns, const std::vector<uint32_t>& generations)
+     *  @brief Construct a query from its attributes.
+     *  @param attributes Indices of the attributes.
+     *  @param columns Columns of the attributes, or nothing when the storage uses archetypes.
+     *  @param generations Slot generations of the EntityStorage.
+     ***
+     *  @fn void EntityQuery::forEach(Function function)
+     *  @brief Call a function for every matched entity.
+     *
+     *  The function is given the ID of the entity followed by references to the attribute values, in the same order as the attributes of the query. Entities must not be created or removed from within the function. With archetypes, the values are visited chunk by chunk.
+     *
+     *  With columns, the values are visited in the packed order of the columns for as long as it agrees with the order of the matched entities, and looked up per entity and attribute from the first entity where it does not. The orders agree when every entity is created with all the attributes of the query and only such entities are created, since the columns and the query then pack their entities in the same way. Otherwise, use EntityManager::sortColumns to line the columns up with the query, and call it again once entities have been created or removed. Only the EntityStorage::ARCHETYPES layout keeps every query contiguous by itself.
+     *  @tparam Function Callable with the signature void(EntityId, DataTypes&...).
+     *  @param function Function to call.
+     ***
+     *  @fn void EntityQuery::forEachParallel(ThreadPool& threadPool, Function function, uint32_t grainSize = 1024)
+     *  @brief Call a function for every matched entity, splitting the entities over the threads of a pool.
+     *
+     *  Works like EntityQuery::forEach, but the function is called from several threads at the same time, each one working on a different batch of entities. This is only safe if the function accesses nothing but the attributes of the entity it is given, or data which is otherwise synchronized. With archetypes, every batch is one chunk and the grain size is ignored.
+     *  @tparam Function Callable with the signature void(EntityId, DataTypes&...).
+     *  @param threadPool Pool to run the batches on.
+     *  @param function Function to call.
+     *  @param grainSize Maximum amount of entities per batch.
+     ***/
+}
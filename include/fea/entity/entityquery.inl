@@ -0,0 +1,97 @@
+template<class... DataTypes>
+EntityQuery<DataTypes...>::EntityQuery(const std::vector<uint32_t>& attributes, const std::vector<AttributeColumnBase*>& columns, const std::vector<uint32_t>& generations) : EntityQueryBase(attributes, columns, generations)
+{
+}
+
+template<class... DataTypes>
+template<class Function>
+void EntityQuery<DataTypes...>::forEach(Function function)
+{
+    if(mColumns.empty())
+        forEachInArchetypes(function, typename MakeIndexSequence<sizeof...(DataTypes)>::Type());
+    else
+        forEachInRange(function, 0, mMatches.size(), typename MakeIndexSequence<sizeof...(DataTypes)>::Type());
+}
+
+template<class... DataTypes>
+template<class Function>
+void EntityQuery<DataTypes...>::forEachParallel(ThreadPool& threadPool, Function function, uint32_t grainSize)
+{
+    if(mColumns.empty())
+    {
+        std::vector<std::pair<Archetype*, uint32_t>> chunks;
+
+        for(Archetype* archetype : mArchetypes)
+        {
+            uint32_t capacity = archetype->getChunkCapacity();
+
+            for(uint32_t first = 0, chunk = 0; first < archetype->size(); first += capacity, chunk++)
+                chunks.emplace_back(archetype, chunk);
+        }
+
+        threadPool.parallelFor(static_cast<uint32_t>(chunks.size()), 1, [&] (uint32_t begin, uint32_t end)
+        {
+            for(uint32_t i = begin; i < end; i++)
+                forEachInChunk(function, *chunks[i].first, chunks[i].second, typename MakeIndexSequence<sizeof...(DataTypes)>::Type());
+        });
+    }
+    else
+    {
+        threadPool.parallelFor(mMatches.size(), grainSize, [&] (uint32_t begin, uint32_t end)
+        {
+            forEachInRange(function, begin, end, typename MakeIndexSequence<sizeof...(DataTypes)>::Type());
+        });
+    }
+}
+
+template<class... DataTypes>
+template<class Function, uint32_t... Indices>
+void EntityQuery<DataTypes...>::forEachInArchetypes(Function& function, IndexSequence<Indices...> indices)
+{
+    for(Archetype* archetype : mArchetypes)
+    {
+        uint32_t capacity = archetype->getChunkCapacity();
+
+        for(uint32_t first = 0, chunk = 0; first < archetype->size(); first += capacity, chunk++)
+            forEachInChunk(function, *archetype, chunk, indices);
+    }
+}
+
+template<class... DataTypes>
+template<class Function, uint32_t... Indices>
+void EntityQuery<DataTypes...>::forEachInRange(Function& function, uint32_t begin, uint32_t end, IndexSequence<Indices...>)
+{
+    const std::vector<uint32_t>& ids = mMatches.getIds();
+    uint32_t packedEnd = getPackedEnd(begin, end);
+    std::tuple<typename AttributeColumn<DataTypes>::Storage::iterator...> values(static_cast<AttributeColumn<DataTypes>*>(mColumns[Indices])->getValues().begin()...);
+
+    //while the columns are lined up with the matches, the value at index i belongs to the match at index i
+    for(uint32_t i = begin; i < packedEnd; i++)
+    {
+        uint32_t id = ids[i];
+        function(makeEntityId(id, mGenerations[id]), std::get<Indices>(values)[i]...);
+    }
+
+    for(uint32_t i = packedEnd; i < end; i++)
+    {
+        uint32_t id = ids[i];
+        function(makeEntityId(id, mGenerations[id]), static_cast<AttributeColumn<DataTypes>*>(mColumns[Indices])->get(id)...);
+    }
+}
+
+template<class... DataTypes>
+template<class Function, uint32_t... Indices>
+void EntityQuery<DataTypes...>::forEachInChunk(Function& function, Archetype& archetype, uint32_t chunk, IndexSequence<Indices...>)
+{
+    const std::vector<uint32_t>& ids = archetype.getIds();
+    uint32_t capacity = archetype.getChunkCapacity();
+    uint32_t first = chunk * capacity;
+    uint32_t rows = std::min(capacity, static_cast<uint32_t>(ids.size()) - first);
+    void* data[] = {archetype.getChunkData(chunk, mAttributes[Indices])...};
+
+    for(uint32_t row = 0; row < rows; row++)
+    {
+        uint32_t id = ids[first + row];
+        function(makeEntityId(id, mGenerations[id]), static_cast<DataTypes*>(data[Indices])[row]...);
+    }
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <fea/config.hpp>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fea/assert.hpp>
+
+namespace fea
+{
+    class FEA_API SnapshotWriter
+    {
+        public:
+            SnapshotWriter(std::vector<uint8_t>& data);
+            void write(const void* source, uint32_t size);
+            template<class DataType>
+            void write(const DataType& value);
+            void write(const std::string& value);
+            uint8_t* allocate(uint32_t size);
+        private:
+            std::vector<uint8_t>& mData;
+    };
+
+    class FEA_API SnapshotReader
+    {
+        public:
+            SnapshotReader(const uint8_t* data, size_t size);
+            void read(void* destination, uint32_t size);
+            template<class DataType>
+            DataType read();
+            std::string readString();
+            const uint8_t* skip(uint32_t size);
+            bool isAtEnd() const;
+            size_t getRemainingSize() const;
+            bool hasFailed() const;
+        private:
+            const uint8_t* mData;
+            size_t mSize;
+            size_t mPosition;
+            bool mFailed;
+    };
+
+    struct FEA_API AttributeSerializer
+    {
+        std::function<void(const void* value, SnapshotWriter& writer)> mWrite;
+        std::function<void(void* value, SnapshotReader& reader)> mRead;
+    };
+
+#include <fea/entity/entitysnapshot.inl>
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class SnapshotWriter
+     *  @class SnapshotReader
+     *  @class AttributeSerializer
+     *@}
+     ***
+     *  @class SnapshotWriter
+     *  @brief Appends binary data to a snapshot buffer.
+     *
+     *  Used by EntityManager::saveSnapshot, and given to the serializers of attribute types which are not trivially copyable. Values are written in the byte order of the machine, so snapshots are only meant to be read back on the same kind of platform.
+     ***
+     *  @fn SnapshotWriter::SnapshotWriter(std::vector<uint8_t>& data)
+     *  @brief Construct a writer appending to a buffer.
+     *  @param data Buffer to append to.
+     ***
+     *  @fn void SnapshotWriter::write(const void* source, uint32_t size)
+     *  @brief Append raw bytes.
+     *  @param source Bytes to append.
+     *  @param size Amount of bytes.
+     ***
+     *  @fn void SnapshotWriter::write(const DataType& value)
+     *  @brief Append the bytes of a trivially copyable value.
+     *  @tparam DataType Type of the value.
+     *  @param value Value to append.
+     ***
+     *  @fn void SnapshotWriter::write(const std::string& value)
+     *  @brief Append a string as its length followed by its characters.
+     *  @param value String to append.
+     ***
+     *  @fn uint8_t* SnapshotWriter::allocate(uint32_t size)
+     *  @brief Grow the buffer and return the added bytes to be filled in directly.
+     *
+     *  The returned pointer is invalidated by the next write.
+     *  @param size Amount of bytes.
+     *  @return Pointer to the added bytes.
+     ***
+     *  @class SnapshotReader
+     *  @brief Reads binary data written by a SnapshotWriter.
+     *
+     *  Reading past the end of the data reads zeros and empty strings instead, and marks the reader as failed. Every read after that fails as well, so it is enough to check SnapshotReader::hasFailed once everything has been read.
+     ***
+     *  @fn SnapshotReader::SnapshotReader(const uint8_t* data, size_t size)
+     *  @brief Construct a reader for a block of memory.
+     *  @param data Data to read. Must outlive the reader.
+     *  @param size Size of the data in bytes.
+     ***
+     *  @fn void SnapshotReader::read(void* destination, uint32_t size)
+     *  @brief Read raw bytes. If not enough data is left, the reader fails and the destination is filled with zeros.
+     *  @param destination Memory to read into.
+     *  @param size Amount of bytes.
+     ***
+     *  @fn DataType SnapshotReader::read()
+     *  @brief Read a trivially copyable value.
+     *  @tparam DataType Type of the value.
+     *  @return The value.
+     ***
+     *  @fn std::string SnapshotReader::readString()
+     *  @brief Read a string written by SnapshotWriter::write(const std::string&).
+     *  @return The string.
+     ***
+     *  @fn const uint8_t* SnapshotReader::skip(uint32_t size)
+     *  @brief Skip over bytes without copying them.
+     *  @param size Amount of bytes.
+     *  @return Pointer to the skipped bytes, or nullptr if not enough data is left, in which case the reader fails.
+     ***
+     *  @fn bool SnapshotReader::isAtEnd() const
+     *  @brief Check if all data has been read.
+     *  @return True if nothing is left.
+     ***
+     *  @fn size_t SnapshotReader::getRemainingSize() const
+     *  @brief Get the amount of bytes left to read. Useful for checking a count read from the data before allocating memory for it.
+     *  @return Amount of bytes.
+     ***
+     *  @fn bool SnapshotReader::hasFailed() const
+     *  @brief Check if any read went past the end of the data.
+     *  @return True if a read has failed.
+     ***
+     *  @class AttributeSerializer
+     *  @brief Functions writing and reading attribute values of a type which can not be copied as raw bytes.
+     *
+     *  Set using EntityManager::setSerializer. mWrite is given a pointer to the value to write, and mRead is given a pointer to a default constructed value to read into.
+     ***/
+}
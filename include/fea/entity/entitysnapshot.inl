@@ -0,0 +1,15 @@
+template<class DataType>
+void SnapshotWriter::write(const DataType& value)
+{
+    static_assert(std::is_trivially_copyable<DataType>::value, "Only trivially copyable values can be written as raw bytes");
+    write(&value, sizeof(DataType));
+}
+
+template<class DataType>
+DataType SnapshotReader::read()
+{
+    static_assert(std::is_trivially_copyable<DataType>::value, "Only trivially copyable values can be read as raw bytes");
+    DataType value;
+    read(&value, sizeof(DataType));
+    return value;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <fea/config.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fea
+{
+    struct FEA_API AttributeStats
+    {
+        std::string mName;
+        uint32_t mCount;
+        uint64_t mUsedBytes;
+        uint64_t mReservedBytes;
+        uint32_t mAllocationCount;
+    };
+
+    struct FEA_API EntityStats
+    {
+        uint32_t mEntityCount;
+        uint32_t mSlotCount;
+        uint32_t mFreeIdCount;
+        uint64_t mReservedIdBytes;
+        uint64_t mReservedHandleBytes;
+        uint32_t mArchetypeCount;
+        uint32_t mUsedChunkCount;
+        uint32_t mFreeChunkCount;
+        uint64_t mReservedChunkBytes;
+        float mAttributeLoadFactor;
+        float mSerializerLoadFactor;
+        std::vector<AttributeStats> mAttributes;
+    };
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class AttributeStats
+     *  @class EntityStats
+     *@}
+     ***
+     *  @class AttributeStats
+     *  @brief Memory used by the values of one attribute. Part of EntityStats.
+     ***
+     *  @var AttributeStats::mName
+     *  @brief Name of the attribute.
+     ***
+     *  @var AttributeStats::mCount
+     *  @brief Amount of entities having the attribute.
+     ***
+     *  @var AttributeStats::mUsedBytes
+     *  @brief Bytes taken up by the values of all entities having the attribute, not counting memory the values themselves point to.
+     ***
+     *  @var AttributeStats::mReservedBytes
+     *  @brief Bytes allocated for values of the attribute, including room for entities not yet created.
+     ***
+     *  @var AttributeStats::mAllocationCount
+     *  @brief Amount of memory blocks holding the values. In the EntityStorage::ARCHETYPES layout this is the amount of chunks of the archetypes having the attribute, and every chunk also holds the other attributes of its archetype.
+     ***
+     *  @class EntityStats
+     *  @brief Occupancy and memory statistics of an EntityManager, filled in by EntityManager::getStats.
+     ***
+     *  @var EntityStats::mEntityCount
+     *  @brief Amount of existing entities.
+     ***
+     *  @var EntityStats::mSlotCount
+     *  @brief Amount of entity slots, which is the highest amount of entities that has existed at the same time.
+     ***
+     *  @var EntityStats::mFreeIdCount
+     *  @brief Amount of slots waiting to be reused by new entities.
+     ***
+     *  @var EntityStats::mReservedIdBytes
+     *  @brief Bytes allocated for keeping track of entity slots and of which entities have which attributes.
+     ***
+     *  @var EntityStats::mReservedHandleBytes
+     *  @brief Bytes allocated by the EntityManager for entity handles and Entity pointers, not counting the Entity instances.
+     ***
+     *  @var EntityStats::mArchetypeCount
+     *  @brief Amount of archetypes. Always zero in the EntityStorage::COLUMNS layout.
+     ***
+     *  @var EntityStats::mUsedChunkCount
+     *  @brief Amount of archetype chunks in use.
+     ***
+     *  @var EntityStats::mFreeChunkCount
+     *  @brief Amount of archetype chunks kept by the ChunkPool for reuse.
+     ***
+     *  @var EntityStats::mReservedChunkBytes
+     *  @brief Bytes allocated by the ChunkPool, including free chunks.
+     ***
+     *  @var EntityStats::mAttributeLoadFactor
+     *  @brief Load factor of the hash table looking up attributes by name.
+     ***
+     *  @var EntityStats::mSerializerLoadFactor
+     *  @brief Load factor of the hash table looking up snapshot serializers by type.
+     ***
+     *  @var EntityStats::mAttributes
+     *  @brief Statistics of every registered attribute, indexed by attribute index.
+     ***/
+}
@@ -1,54 +1,281 @@
 #pragma once
 #include <fea/config.hpp>
-#include <stack>
+#include <array>
+#include <atomic>
+#include <map>
 #include <unordered_map>
 #include <unordered_set>
 #include <memory>
 #include <set>
 #include <typeindex>
 #include <fea/assert.hpp>
+#include <fea/entity/attributecolumn.hpp>
+#include <fea/entity/attributehandle.hpp>
+#include <fea/entity/attributeindex.hpp>
+#include <fea/entity/attributetype.hpp>
+#include <fea/entity/archetype.hpp>
+#include <fea/entity/changetracker.hpp>
+#include <fea/entity/entityid.hpp>
+#include <fea/entity/entityquery.hpp>
+#include <fea/entity/entitysnapshot.hpp>
+#include <fea/entity/entitystats.hpp>
 
 namespace fea
 {
     class FEA_API EntityStorage
     {
-        class StorageEntity
-        {
-            public:
-                StorageEntity(const std::set<std::string>& attributeList);
-                template<class DataType>
-                void setData(const std::string& attribute, DataType inData);
-                template<class DataType>
-                const DataType& getData(const std::string& attribute) const;
-                template<class DataType>
-                DataType& getData(const std::string& attribute);
-                bool hasData(const std::string& attribute) const;
-                std::unordered_set<std::string> getAttributes() const;
-            private:
-                std::unordered_map<std::string, std::shared_ptr<void>> attributeData;
-        };
-
         public:
-        EntityStorage();
-        uint32_t addEntity(const std::set<std::string>& attributeList);
-        void removeEntity(uint32_t id);
+        enum StorageLayout { COLUMNS, ARCHETYPES };
+
+        EntityStorage(StorageLayout layout = COLUMNS);
+        StorageLayout getLayout() const;
+        EntityId addEntity(const std::set<std::string>& attributeList);
+        EntityId addEntity(const std::vector<uint32_t>& attributes);
+        std::vector<EntityId> addEntities(const std::set<std::string>& attributeList, uint32_t count);
+        std::vector<EntityId> addEntities(const std::vector<uint32_t>& attributes, uint32_t count);
+        void removeEntity(EntityId id);
+        void removeEntities(const std::vector<EntityId>& ids);
+        std::vector<EntityId> cloneEntity(uint32_t id, uint32_t count);
+        bool isValid(EntityId id) const;
+        template<class DataType>
+        AttributeHandle<DataType> registerAttribute(const std::string& attribute);
         template<class DataType>
-        void registerAttribute(const std::string& attribute);
+        AttributeHandle<DataType> getAttributeHandle(const std::string& attribute) const;
         template<class DataType>
         void setData(const uint32_t id, const std::string& attribute, DataType inData);
         template<class DataType>
+        void setData(const uint32_t id, const AttributeHandle<DataType>& attribute, DataType inData);
+        template<class DataType>
         const DataType& getData(const uint32_t id, const std::string& attribute) const;
         template<class DataType>
         DataType& getData(const uint32_t id, const std::string& attribute);
+        template<class DataType>
+        const DataType& getData(const uint32_t id, const AttributeHandle<DataType>& attribute) const;
+        template<class DataType>
+        DataType& getData(const uint32_t id, const AttributeHandle<DataType>& attribute);
         bool hasData(const uint32_t id, const std::string& attribute) const;
+        template<class DataType>
+        bool hasData(const uint32_t id, const AttributeHandle<DataType>& attribute) const;
+        bool hasData(const uint32_t id, uint32_t attribute) const;
+        void* getValue(const uint32_t id, uint32_t attribute);
+        const void* getValue(const uint32_t id, uint32_t attribute) const;
+        void shareValues(const std::vector<EntityId>& ids, uint32_t attribute, const void* value);
+        void retainSharedValues(std::shared_ptr<const void> owner);
+        const void* getSharedValue(const uint32_t id, uint32_t attribute) const;
+        void unshareValue(const uint32_t id, uint32_t attribute, bool copy);
+        void unshareAttribute(uint32_t attribute);
         bool attributeIsValid(const std::string& attribute) const;
+        uint32_t getAttributeIndex(const std::string& attribute) const;
+        uint32_t getAttributeCount() const;
+        const AttributeType& getAttributeType(uint32_t attribute) const;
+        template<class DataType>
+        const AttributeColumn<DataType>& getColumn(const AttributeHandle<DataType>& attribute) const;
+        template<class DataType>
+        AttributeColumn<DataType>& getColumn(const AttributeHandle<DataType>& attribute);
+        template<class... DataTypes>
+        EntityQuery<DataTypes...>& query(const AttributeHandle<DataTypes>&... attributes);
+        template<class... DataTypes>
+        EntityQuery<DataTypes...>& query(const std::array<std::string, sizeof...(DataTypes)>& attributes);
+        void sortColumns(const EntityQueryBase& query);
+        void beginConcurrentAccess();
+        void endConcurrentAccess();
+        bool isConcurrentAccess() const;
+        void trackChanges(uint32_t attribute);
+        bool isTrackingChanges(uint32_t attribute) const;
+        void markChanged(const uint32_t id, uint32_t attribute);
+        const ChangeTracker& getChangeTracker(uint32_t attribute) const;
+        uint32_t getFrame() const;
+        void nextFrame();
+        template<class IndexType, class... Args>
+        void addIndex(uint32_t attribute, Args&&... args);
+        template<class IndexType>
+        IndexType& getIndex(uint32_t attribute);
+        void fillIndex(AttributeIndexBase& index);
+        void refreshIndex(AttributeIndexBase& index);
+        void updateIndex(AttributeIndexBase& index, EntityId id);
+        template<class DataType>
+        void setSerializer(std::function<void(const DataType&, SnapshotWriter&)> write, std::function<void(DataType&, SnapshotReader&)> read);
+        void writeSnapshot(SnapshotWriter& writer) const;
+        bool readSnapshot(SnapshotReader& reader, std::vector<EntityId>& ids);
+        void getStats(EntityStats& stats) const;
         void clear();
         std::unordered_set<std::string> getAttributes(uint32_t id) const;
+        std::vector<uint32_t> getEntityAttributes(uint32_t id) const;
+        template<class... DataTypes, uint32_t... Indices>
+        EntityQuery<DataTypes...>& queryByName(const std::array<std::string, sizeof...(DataTypes)>& attributes, IndexSequence<Indices...>);
+        std::vector<uint32_t> getAttributeIndices(const std::set<std::string>& attributeList) const;
+        uint32_t allocateId();
+        void insertEntity(uint32_t id, const std::vector<uint32_t>& attributes, uint32_t archetype);
+        uint32_t getArchetype(const std::vector<uint32_t>& attributes);
 
-        std::unordered_map<std::string, std::type_index> mAttributes;
-        std::unordered_map<uint32_t, StorageEntity> mEntities;
-        std::stack<uint32_t> mFreeIds;
-        uint32_t mNextId;
+        std::unordered_map<std::string, uint32_t> mAttributes;
+        std::vector<std::string> mAttributeNames;
+        std::vector<AttributeType> mAttributeTypes;
+        std::vector<std::unique_ptr<AttributeColumnBase>> mColumns;
+        ChunkPool mChunkPool;
+        std::vector<std::unique_ptr<Archetype>> mArchetypes;
+        std::map<std::vector<uint32_t>, uint32_t> mArchetypeIndices;
+        std::vector<uint32_t> mEntityArchetypes;
+        std::map<std::vector<uint32_t>, std::unique_ptr<EntityQueryBase>> mQueries;
+        std::vector<uint32_t> mGenerations;
+        std::vector<uint32_t> mFreeIds;
+        std::unordered_map<std::type_index, AttributeSerializer> mSerializers;
+        std::vector<std::unique_ptr<ChangeTracker>> mChangeTrackers;
+        std::vector<std::unique_ptr<AttributeIndexBase>> mIndexes;
+        std::vector<std::vector<const void*>> mSharedValues;
+        std::vector<std::shared_ptr<const void>> mSharedOwners;
+        StorageLayout mLayout;
+        uint32_t mFrame;
+        std::atomic<uint32_t> mConcurrentAccess;
     };
 #include <fea/entity/entitystorage.inl>
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class EntityStorage
+     *  @enum EntityStorage::StorageLayout
+     *@}
+     ***
+     *  @class EntityStorage
+     *  @brief Stores the attribute values of all entities. Used internally by the EntityManager.
+     *
+     *  The storage hands out the EntityId values. Every entity occupies a slot whose generation is increased both when the entity is removed and when the slot is reused, so live slots have even generations and free slots odd ones. This makes checking an EntityId for validity a single array comparison, which also holds after restoring a snapshot taken before the ID was handed out. The functions accessing attribute values take the slot index of the entity, as given by getEntityIndex.
+     ***
+     *  @fn std::vector<EntityId> EntityStorage::cloneEntity(uint32_t id, uint32_t count)
+     *  @brief Create entities with the same attributes and values as an existing one. See EntityManager::clone.
+     *
+     *  Values shared by the original entity are shared by the clones as well.
+     *  @param id Slot index of the entity to clone.
+     *  @param count Amount of clones to create.
+     *  @return IDs of the clones.
+     ***
+     *  @fn void EntityStorage::shareValues(const std::vector<EntityId>& ids, uint32_t attribute, const void* value)
+     *  @brief Let newly created entities share a value of an attribute instead of storing their own copy.
+     *
+     *  The value is only copied into the storage of an entity when the entity first gets non-const access to it, which is when EntityStorage::unshareValue is called. Values of trivially copyable types and of attributes used by a query are copied right away, since copying them is as cheap as sharing them, and since queries give out references to the stored values. The shared value must stay alive and unchanged for as long as any entity shares it; see EntityStorage::retainSharedValues.
+     *  @param ids IDs of the entities. Must not have been given access to the attribute yet.
+     *  @param attribute Index of the attribute.
+     *  @param value Value to share.
+     ***
+     *  @fn void EntityStorage::retainSharedValues(std::shared_ptr<const void> owner)
+     *  @brief Keep the owner of shared values alive until the storage is cleared or a snapshot is read.
+     *  @param owner Object owning shared values.
+     ***
+     *  @fn const void* EntityStorage::getSharedValue(const uint32_t id, uint32_t attribute) const
+     *  @brief Get the value an entity shares for an attribute.
+     *  @param id Slot index of the entity.
+     *  @param attribute Index of the attribute.
+     *  @return The shared value, or null if the entity stores its own value.
+     ***
+     *  @fn void EntityStorage::unshareValue(const uint32_t id, uint32_t attribute, bool copy)
+     *  @brief Stop an entity from sharing a value, so that its stored value can be written.
+     *  @param id Slot index of the entity.
+     *  @param attribute Index of the attribute.
+     *  @param copy True if the shared value should be copied into the storage, false if the stored value is about to be overwritten anyway.
+     ***
+     *  @fn void EntityStorage::unshareAttribute(uint32_t attribute)
+     *  @brief Copy the shared values of an attribute into the storage of every entity sharing one.
+     *  @param attribute Index of the attribute.
+     ***
+     *  @fn void EntityStorage::sortColumns(const EntityQueryBase& query)
+     *  @brief Reorder the columns of the attributes of a query to line them up with the query. See EntityManager::sortColumns.
+     *  @param query Query to line the columns up with.
+     ***
+     *  @fn void EntityStorage::beginConcurrentAccess()
+     *  @brief Start a section where several threads may access attribute values. See EntityManager::beginConcurrentAccess.
+     ***
+     *  @fn void EntityStorage::endConcurrentAccess()
+     *  @brief End a section started with EntityStorage::beginConcurrentAccess.
+     ***
+     *  @fn bool EntityStorage::isConcurrentAccess() const
+     *  @brief Check if any concurrent access section is active.
+     *  @return True if one is.
+     ***
+     *  @fn void EntityStorage::trackChanges(uint32_t attribute)
+     *  @brief Start recording changes to an attribute. See EntityManager::trackChanges.
+     *  @param attribute Index of the attribute.
+     ***
+     *  @fn bool EntityStorage::isTrackingChanges(uint32_t attribute) const
+     *  @brief Check if changes to an attribute are recorded.
+     *  @param attribute Index of the attribute.
+     *  @return True if they are.
+     ***
+     *  @fn void EntityStorage::markChanged(const uint32_t id, uint32_t attribute)
+     *  @brief Record a change to an attribute of an entity in the current frame. Does nothing if the attribute is not tracked.
+     *  @param id Slot index of the entity.
+     *  @param attribute Index of the attribute.
+     ***
+     *  @fn const ChangeTracker& EntityStorage::getChangeTracker(uint32_t attribute) const
+     *  @brief Get the recorded changes to an attribute.
+     *
+     *  Assert/undefined behavior if the attribute is not tracked.
+     *  @param attribute Index of the attribute.
+     *  @return The tracker.
+     ***
+     *  @fn uint32_t EntityStorage::getFrame() const
+     *  @brief Get the frame changes are currently recorded in.
+     *  @return The frame.
+     ***
+     *  @fn void EntityStorage::nextFrame()
+     *  @brief Advance to the next frame.
+     ***
+     *  @fn void EntityStorage::addIndex(uint32_t attribute, Args&&... args)
+     *  @brief Create a secondary index of an attribute, filled with all existing entities. Enables change tracking of the attribute, and of the secondary attribute of the index if it has one. See EntityManager::addHashIndex.
+     *
+     *  Assert/undefined behavior if the secondary attribute is not of the same type as the attribute.
+     *  @tparam IndexType HashIndex, SortedIndex or SpatialIndex of the type of the attribute.
+     *  @tparam Args Types of the additional constructor arguments of the index.
+     *  @param attribute Index of the attribute.
+     *  @param args Additional arguments to pass to the constructor of the index.
+     ***
+     *  @fn IndexType& EntityStorage::getIndex(uint32_t attribute)
+     *  @brief Get a secondary index of an attribute, brought up to date with all changes made since it was last used.
+     *
+     *  During concurrent access the index is not updated, and reflects the values as they were when the access began. Assert/undefined behavior if no such index exists.
+     *  @tparam IndexType HashIndex, SortedIndex or SpatialIndex of the type of the attribute.
+     *  @param attribute Index of the attribute.
+     *  @return The index.
+     ***
+     *  @fn void EntityStorage::fillIndex(AttributeIndexBase& index)
+     *  @brief Rebuild an index from the values of all entities.
+     *  @param index Index to rebuild.
+     ***
+     *  @fn void EntityStorage::refreshIndex(AttributeIndexBase& index)
+     *  @brief Re-index the entities changed since an index was last refreshed.
+     *  @param index Index to refresh.
+     ***
+     *  @fn void EntityStorage::updateIndex(AttributeIndexBase& index, EntityId id)
+     *  @brief Re-index a single entity, removing it from the index if it no longer has the indexed attribute.
+     *  @param index Index to update.
+     *  @param id ID of the entity.
+     ***
+     *  @fn void EntityStorage::setSerializer(std::function<void(const DataType&, SnapshotWriter&)> write, std::function<void(DataType&, SnapshotReader&)> read)
+     *  @brief Set the functions used to write and read values of a type in snapshots. See EntityManager::setSerializer.
+     ***
+     *  @fn void EntityStorage::writeSnapshot(SnapshotWriter& writer) const
+     *  @brief Write the slot generations, the free slots and every attribute column to a snapshot.
+     *
+     *  Every attribute is written as its name and size followed by the IDs of the entities having it. The values of all attributes follow after all IDs, so that the entities can be restored before any value is read.
+     *  @param writer Writer to write to.
+     ***
+     *  @fn bool EntityStorage::readSnapshot(SnapshotReader& reader, std::vector<EntityId>& ids)
+     *  @brief Replace all entities with the ones in a snapshot written by EntityStorage::writeSnapshot.
+     *
+     *  The snapshot must take up the rest of the data of the reader. It is read and checked as a whole before any entity is replaced, and if anything is wrong with it, the storage is left unchanged.
+     *  @param reader Reader to read from.
+     *  @param ids Filled with the IDs of the restored entities, in slot order.
+     *  @return False if the data is not a complete snapshot, is of another snapshot version, or holds attributes which are not registered or have types of other sizes.
+     ***
+     *  @fn void EntityStorage::getStats(EntityStats& stats) const
+     *  @brief Fill in the statistics of the storage. See EntityManager::getStats.
+     *
+     *  EntityStats::mReservedHandleBytes is left to the EntityManager.
+     *  @param stats Statistics to fill in.
+     ***
+     *  @enum EntityStorage::StorageLayout
+     *  @brief How attribute values are laid out in memory.
+     *
+     *  - COLUMNS - Every attribute has one packed AttributeColumn holding the values of all entities having that attribute. Good when entities have varying sets of attributes and systems iterate over few attributes at a time.
+     *  - ARCHETYPES - Entities with exactly the same set of attributes are grouped into an Archetype which stores them in fixed size chunks. Good when many entities are created from the same templates, since creating an entity then only appends a row to a chunk. AttributeColumn instances are not available in this layout.
+     ***/
 }
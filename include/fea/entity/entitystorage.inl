@@ -1,62 +1,216 @@
     template<class DataType>
-    void EntityStorage::StorageEntity::setData(const std::string& attribute, DataType inData)
+    AttributeHandle<DataType> EntityStorage::registerAttribute(const std::string& attribute)
     {
-        FEA_ASSERT(attributeData.find(attribute) != attributeData.end(), "Trying to set the attribute '" + attribute + "' on an entity which does not have said attribute!");
-        auto& valuePointer = attributeData.at(attribute);
+        FEA_ASSERT(mAttributes.find(attribute) == mAttributes.end(), "Trying to register attribute '" + attribute + "' as a '"  + std::type_index(typeid(DataType)).name() + std::string(" but there is already an attribute registered with that identifier!"));
+        FEA_ASSERT(!isConcurrentAccess(), "Trying to register attribute '" + attribute + "' during concurrent access!");
+        uint32_t index = static_cast<uint32_t>(mColumns.size());
+        mAttributes.emplace(attribute, index);
+        mAttributeNames.push_back(attribute);
+        mAttributeTypes.push_back(makeAttributeType<DataType>());
+        mColumns.emplace_back(new AttributeColumn<DataType>());
+        return AttributeHandle<DataType>(index);
+    }
+
+    template<class DataType>
+    AttributeHandle<DataType> EntityStorage::getAttributeHandle(const std::string& attribute) const
+    {
+        FEA_ASSERT(mAttributes.find(attribute) != mAttributes.end(), "Trying to access the attribute '" + attribute + "' but such an attribute has not been registered!");
+        uint32_t index = mAttributes.at(attribute);
+        FEA_ASSERT(std::type_index(typeid(DataType)) == mAttributeTypes[index].mType, "Trying to access attibute '" + attribute + "' as a '" + std::type_index(typeid(DataType)).name() + std::string(" but it is of type '") + std::string(mAttributeTypes[index].mType.name()) + "'");
+        return AttributeHandle<DataType>(index);
+    }
 
-        if(!valuePointer)
-            valuePointer = std::make_shared<DataType>(std::move(inData));
-        else
-            *std::static_pointer_cast<DataType>(valuePointer) = std::move(inData);
+    template<class DataType>
+    void EntityStorage::setData(const uint32_t id, const std::string& attribute, DataType inData)
+    {
+        setData(id, getAttributeHandle<DataType>(attribute), std::move(inData));
     }
 
     template<class DataType>
-    const DataType& EntityStorage::StorageEntity::getData(const std::string& attribute) const
+    void EntityStorage::setData(const uint32_t id, const AttributeHandle<DataType>& attribute, DataType inData)
     {
-        FEA_ASSERT(attributeData.find(attribute) != attributeData.end(), "Trying to get the attribute '" + attribute + "' on an entity which does not have said attribute!");
-        auto& valuePointer = attributeData.at(attribute);
+        FEA_ASSERT(hasData(id, attribute), "Trying to set the attribute '" + mAttributeNames[attribute.getIndex()] + "' on an entity which does not have said attribute!");
+
+        //the shared value would be overwritten right away, so it is not copied
+        if(attribute.getIndex() < mSharedValues.size() && id < mSharedValues[attribute.getIndex()].size() && mSharedValues[attribute.getIndex()][id])
+            unshareValue(id, attribute.getIndex(), false);
 
-        FEA_ASSERT(valuePointer, "Calling getData on attribute '" + attribute + "' which is not initialized!");
-        return *std::static_pointer_cast<DataType>(valuePointer);
+        getData(id, attribute) = std::move(inData);
     }
 
     template<class DataType>
-    DataType& EntityStorage::StorageEntity::getData(const std::string& attribute)
+    const DataType& EntityStorage::getData(const uint32_t id, const std::string& attribute) const
     {
-        FEA_ASSERT(attributeData.find(attribute) != attributeData.end(), "Trying to get the attribute '" + attribute + "' on an entity which does not have said attribute!");
-        auto& valuePointer = attributeData.at(attribute);
+        return getData(id, getAttributeHandle<DataType>(attribute));
+    }
 
-        FEA_ASSERT(valuePointer, "Calling getData on attribute '" + attribute + "' which is not initialized!");
-        return *std::static_pointer_cast<DataType>(valuePointer);
+    template<class DataType>
+    DataType& EntityStorage::getData(const uint32_t id, const std::string& attribute)
+    {
+        return getData(id, getAttributeHandle<DataType>(attribute));
     }
 
     template<class DataType>
-    void EntityStorage::registerAttribute(const std::string& attribute)
+    const DataType& EntityStorage::getData(const uint32_t id, const AttributeHandle<DataType>& attribute) const
     {
-        FEA_ASSERT(mAttributes.find(attribute) == mAttributes.end(), "Trying to register attribute '" + attribute + "' as a '"  + std::type_index(typeid(DataType)).name() + std::string(" but there is already an attribute registered with that identifier!"));
-        mAttributes.emplace(attribute, typeid(DataType));
+        FEA_ASSERT(hasData(id, attribute), "Trying to get the attribute '" + mAttributeNames[attribute.getIndex()] + "' on an entity which does not have said attribute!");
+
+        if(attribute.getIndex() < mSharedValues.size() && id < mSharedValues[attribute.getIndex()].size() && mSharedValues[attribute.getIndex()][id])
+            return *static_cast<const DataType*>(mSharedValues[attribute.getIndex()][id]);
+
+        if(mLayout == COLUMNS)
+            return getColumn(attribute).get(id);
+
+        FEA_ASSERT(std::type_index(typeid(DataType)) == mAttributeTypes[attribute.getIndex()].mType, "Trying to access attibute '" + mAttributeNames[attribute.getIndex()] + "' as a '" + std::type_index(typeid(DataType)).name() + std::string(" but it is of type '") + std::string(mAttributeTypes[attribute.getIndex()].mType.name()) + "'");
+        return *static_cast<const DataType*>(mArchetypes[mEntityArchetypes[id]]->getValue(id, attribute.getIndex()));
     }
 
     template<class DataType>
-    void EntityStorage::setData(const uint32_t id, const std::string& attribute, DataType inData)
+    DataType& EntityStorage::getData(const uint32_t id, const AttributeHandle<DataType>& attribute)
     {
-        FEA_ASSERT(mAttributes.find(attribute) != mAttributes.end(), "Trying to set the attribute '" + attribute + "' on an entity but such an attribute has not been registered!");
-        FEA_ASSERT(std::type_index(typeid(DataType)) == mAttributes.at(attribute), "Trying to set attibute '" + attribute + "' as a '" + std::type_index(typeid(DataType)).name() + std::string(" but it is of type '") + std::string(mAttributes.at(attribute).name()) + "'");
-        mEntities.at(id).setData(attribute, std::move(inData));
+        FEA_ASSERT(hasData(id, attribute), "Trying to get the attribute '" + mAttributeNames[attribute.getIndex()] + "' on an entity which does not have said attribute!");
+
+        //non-const access counts as a change since the value may be written through the reference
+        if(attribute.getIndex() < mChangeTrackers.size() && mChangeTrackers[attribute.getIndex()])
+            markChanged(id, attribute.getIndex());
+
+        //and for the same reason gives the entity its own copy of a shared value
+        if(attribute.getIndex() < mSharedValues.size() && id < mSharedValues[attribute.getIndex()].size() && mSharedValues[attribute.getIndex()][id])
+            unshareValue(id, attribute.getIndex(), true);
+
+        if(mLayout == COLUMNS)
+            return getColumn(attribute).get(id);
+
+        FEA_ASSERT(std::type_index(typeid(DataType)) == mAttributeTypes[attribute.getIndex()].mType, "Trying to access attibute '" + mAttributeNames[attribute.getIndex()] + "' as a '" + std::type_index(typeid(DataType)).name() + std::string(" but it is of type '") + std::string(mAttributeTypes[attribute.getIndex()].mType.name()) + "'");
+        return *static_cast<DataType*>(mArchetypes[mEntityArchetypes[id]]->getValue(id, attribute.getIndex()));
     }
 
     template<class DataType>
-    const DataType& EntityStorage::getData(const uint32_t id, const std::string& attribute) const
+    bool EntityStorage::hasData(const uint32_t id, const AttributeHandle<DataType>& attribute) const
     {
-        FEA_ASSERT(mAttributes.find(attribute) != mAttributes.end(), "Trying to get the attribute '" + attribute + "' on an entity but such an attribute has not been registered!");
-        FEA_ASSERT(std::type_index(typeid(DataType)) == mAttributes.at(attribute), "Trying to get attibute '" + attribute + "' as a '" + std::type_index(typeid(DataType)).name() + std::string(" but it is of type '") + std::string(mAttributes.at(attribute).name()) + "'");
-        return mEntities.at(id).getData<DataType>(attribute);
+        FEA_ASSERT(attribute.getIndex() < mColumns.size(), "Trying to access an attribute using an invalid handle!");
+        return hasData(id, attribute.getIndex());
     }
 
     template<class DataType>
-    DataType& EntityStorage::getData(const uint32_t id, const std::string& attribute)
+    const AttributeColumn<DataType>& EntityStorage::getColumn(const AttributeHandle<DataType>& attribute) const
+    {
+        FEA_ASSERT(mLayout == COLUMNS, "Attribute columns are only available in the COLUMNS storage layout!");
+        FEA_ASSERT(attribute.getIndex() < mColumns.size(), "Trying to access an attribute using an invalid handle!");
+        const AttributeColumnBase& column = *mColumns[attribute.getIndex()];
+        FEA_ASSERT(std::type_index(typeid(DataType)) == column.getType(), "Trying to access attibute '" + mAttributeNames[attribute.getIndex()] + "' as a '" + std::type_index(typeid(DataType)).name() + std::string(" but it is of type '") + std::string(column.getType().name()) + "'");
+        return static_cast<const AttributeColumn<DataType>&>(column);
+    }
+
+    template<class DataType>
+    AttributeColumn<DataType>& EntityStorage::getColumn(const AttributeHandle<DataType>& attribute)
+    {
+        FEA_ASSERT(mLayout == COLUMNS, "Attribute columns are only available in the COLUMNS storage layout!");
+        FEA_ASSERT(attribute.getIndex() < mColumns.size(), "Trying to access an attribute using an invalid handle!");
+        AttributeColumnBase& column = *mColumns[attribute.getIndex()];
+        FEA_ASSERT(std::type_index(typeid(DataType)) == column.getType(), "Trying to access attibute '" + mAttributeNames[attribute.getIndex()] + "' as a '" + std::type_index(typeid(DataType)).name() + std::string(" but it is of type '") + std::string(column.getType().name()) + "'");
+        return static_cast<AttributeColumn<DataType>&>(column);
+    }
+
+    template<class... DataTypes>
+    EntityQuery<DataTypes...>& EntityStorage::query(const AttributeHandle<DataTypes>&... attributes)
+    {
+        std::vector<uint32_t> key = {attributes.getIndex()...};
+        auto iterator = mQueries.find(key);
+
+        if(iterator == mQueries.end())
+        {
+            FEA_ASSERT(!isConcurrentAccess(), "Trying to create a new query during concurrent access! Create it beforehand.");
+
+            //queries give out references to the stored values, so those have to hold the actual values
+            for(uint32_t attribute : key)
+                unshareAttribute(attribute);
+
+            if(mLayout == COLUMNS)
+            {
+                iterator = mQueries.emplace(key, std::unique_ptr<EntityQueryBase>(new EntityQuery<DataTypes...>(key, {&getColumn(attributes)...}, mGenerations))).first;
+            }
+            else
+            {
+                iterator = mQueries.emplace(key, std::unique_ptr<EntityQueryBase>(new EntityQuery<DataTypes...>(key, {}, mGenerations))).first;
+
+                for(auto& archetype : mArchetypes)
+                    iterator->second->archetypeCreated(*archetype);
+            }
+        }
+
+        return static_cast<EntityQuery<DataTypes...>&>(*iterator->second);
+    }
+
+    template<class... DataTypes>
+    EntityQuery<DataTypes...>& EntityStorage::query(const std::array<std::string, sizeof...(DataTypes)>& attributes)
+    {
+        return queryByName<DataTypes...>(attributes, typename MakeIndexSequence<sizeof...(DataTypes)>::Type());
+    }
+
+    template<class... DataTypes, uint32_t... Indices>
+    EntityQuery<DataTypes...>& EntityStorage::queryByName(const std::array<std::string, sizeof...(DataTypes)>& attributes, IndexSequence<Indices...>)
+    {
+        return query(getAttributeHandle<DataTypes>(attributes[Indices])...);
+    }
+
+    template<class IndexType, class... Args>
+    void EntityStorage::addIndex(uint32_t attribute, Args&&... args)
+    {
+        FEA_ASSERT(attribute < mAttributeTypes.size(), "Trying to add an index to an attribute using an invalid index!");
+        FEA_ASSERT(std::type_index(typeid(typename IndexType::Type)) == mAttributeTypes[attribute].mType, "Trying to index attribute '" + mAttributeNames[attribute] + "' as a '" + std::type_index(typeid(typename IndexType::Type)).name() + std::string("' but it is of type '") + std::string(mAttributeTypes[attribute].mType.name()) + "'");
+        FEA_ASSERT(!isConcurrentAccess(), "Trying to add an index to attribute '" + mAttributeNames[attribute] + "' during concurrent access!");
+
+        for(const auto& index : mIndexes)
+        {
+            FEA_ASSERT(index->getAttribute() != attribute || typeid(*index) != typeid(IndexType), "Trying to add an index to attribute '" + mAttributeNames[attribute] + "' but it already has an index of that kind!");
+        }
+
+        std::unique_ptr<AttributeIndexBase> index(new IndexType(attribute, std::forward<Args>(args)...));
+        uint32_t secondary = index->getSecondaryAttribute();
+
+        trackChanges(attribute);
+
+        if(secondary != AttributeIndexBase::noAttribute)
+        {
+            FEA_ASSERT(secondary < mAttributeTypes.size(), "Trying to add an index to attribute '" + mAttributeNames[attribute] + "' with an invalid secondary attribute index!");
+            FEA_ASSERT(mAttributeTypes[secondary].mType == mAttributeTypes[attribute].mType, "Trying to add an index to attribute '" + mAttributeNames[attribute] + "' with the secondary attribute '" + mAttributeNames[secondary] + "' which is of another type!");
+            trackChanges(secondary);
+        }
+
+        mIndexes.push_back(std::move(index));
+        fillIndex(*mIndexes.back());
+    }
+
+    template<class IndexType>
+    IndexType& EntityStorage::getIndex(uint32_t attribute)
+    {
+        for(auto& index : mIndexes)
+        {
+            if(index->getAttribute() == attribute && typeid(*index) == typeid(IndexType))
+            {
+                if(!isConcurrentAccess())
+                    refreshIndex(*index);
+
+                return static_cast<IndexType&>(*index);
+            }
+        }
+
+        FEA_ASSERT(false, "Trying to use an index of attribute '" + mAttributeNames[attribute] + "' which has not been added!");
+        return static_cast<IndexType&>(*mIndexes.front());
+    }
+
+    template<class DataType>
+    void EntityStorage::setSerializer(std::function<void(const DataType&, SnapshotWriter&)> write, std::function<void(DataType&, SnapshotReader&)> read)
     {
-        FEA_ASSERT(mAttributes.find(attribute) != mAttributes.end(), "Trying to get the attribute '" + attribute + "' on an entity but such an attribute has not been registered!");
-        FEA_ASSERT(std::type_index(typeid(DataType)) == mAttributes.at(attribute), "Trying to get attibute '" + attribute + "' as a '" + std::type_index(typeid(DataType)).name() + std::string(" but it is of type '") + std::string(mAttributes.at(attribute).name()) + "'");
-        return mEntities.at(id).getData<DataType>(attribute);
+        AttributeSerializer serializer;
+        serializer.mWrite = [write] (const void* value, SnapshotWriter& writer)
+        {
+            write(*static_cast<const DataType*>(value), writer);
+        };
+        serializer.mRead = [read] (void* value, SnapshotReader& reader)
+        {
+            read(*static_cast<DataType*>(value), reader);
+        };
+        mSerializers[std::type_index(typeid(DataType))] = std::move(serializer);
     }
@@ -16,8 +16,11 @@ namespace fea
     {
         public:
             std::vector<std::pair<std::string, EntityTemplate>> loadEntityTemplates(const std::string& path);
+            void loadEntityTemplates(const std::vector<std::string>& paths, EntityFactory& factory, const std::string& cachePath);
             std::unordered_map<std::string, std::string> loadEntityAttributes(const std::string& path);
         private:
+            static std::string readFile(const std::string& path);
+            std::vector<std::pair<std::string, EntityTemplate>> parseEntityTemplates(const std::string& source);
             std::unordered_map<std::string, std::string> jsonObjToStringMap(const Json::Value&);
     };
     /** @addtogroup EntitySystem
@@ -87,6 +90,17 @@ namespace fea
      *  @param path File to open.
      *  @return A map with the entity templates.
      ***
+     *  @fn void JsonEntityLoader::loadEntityTemplates(const std::vector<std::string>& paths, EntityFactory& factory, const std::string& cachePath)
+     *  @brief Add all entity templates of several json files to a factory, using a binary cache to skip parsing when the files have not changed.
+     *
+     *  The files are hashed and compared with the hash stored in the cache. If they match, the compiled templates are loaded straight from the cache using EntityFactory::loadTemplateCache, with no json or default value parsing at all. Otherwise the files are parsed, the templates added, and the cache rewritten. This makes starting up with many template files about as fast as reading them.
+     *
+     *  The files are processed in order, so templates may inherit templates from earlier files. Templates inheriting from templates outside of these files are cached with the inherited values as they were, so such parents should be loaded as part of the same call. The attributes must be registered before calling this.
+     *  Throws FileNotFoundException when one of the files does not exist.
+     *  @param paths Files to load.
+     *  @param factory Factory to add the templates to.
+     *  @param cachePath File to use as cache. Created if it does not exist.
+     ***
      *  @fn std::unordered_map<std::string, std::string> JsonEntityLoader::loadEntityAttributes(const std::string& path)
      *  @brief Load a json file defining entity attributes.
      *
@@ -0,0 +1,89 @@
+#pragma once
+#include <fea/config.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace fea
+{
+    class FEA_API SparseSet
+    {
+        public:
+            bool has(uint32_t id) const;
+            uint32_t insert(uint32_t id);
+            uint32_t erase(uint32_t id);
+            uint32_t getIndex(uint32_t id) const;
+            void swap(uint32_t first, uint32_t second);
+            uint32_t size() const;
+            const std::vector<uint32_t>& getIds() const;
+            void reserve(uint32_t amount);
+            void clear();
+            uint64_t getReservedBytes() const;
+        private:
+            std::vector<uint32_t> mSparse;
+            std::vector<uint32_t> mDense;
+    };
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class SparseSet
+     *@}
+     ***
+     *  @class SparseSet
+     *  @brief Set of integer IDs with constant time insertion, removal and lookup.
+     *
+     *  The IDs are kept packed in a dense array which can be iterated directly, and a sparse array maps every ID to its position in the dense array. Removal moves the last ID into the place of the removed one, so the order of the dense array is not stable. This is used to index the attribute columns of the EntityStorage.
+     ***
+     *  @fn bool SparseSet::has(uint32_t id) const
+     *  @brief Check if an ID is in the set.
+     *  @param id ID to check for.
+     *  @return True if the ID exists.
+     ***
+     *  @fn uint32_t SparseSet::insert(uint32_t id)
+     *  @brief Add an ID to the end of the dense array.
+     *
+     *  Assert/undefined behavior if the ID already exists.
+     *  @param id ID to add.
+     *  @return Dense index of the added ID.
+     ***
+     *  @fn uint32_t SparseSet::erase(uint32_t id)
+     *  @brief Remove an ID from the set.
+     *
+     *  The last ID of the dense array is moved into the dense index that the removed ID occupied.
+     *  Assert/undefined behavior if the ID does not exist.
+     *  @param id ID to remove.
+     *  @return Dense index that the removed ID occupied.
+     ***
+     *  @fn uint32_t SparseSet::getIndex(uint32_t id) const
+     *  @brief Get the dense index of an ID.
+     *
+     *  Assert/undefined behavior if the ID does not exist.
+     *  @param id ID to get the index of.
+     *  @return Dense index.
+     ***
+     *  @fn void SparseSet::swap(uint32_t first, uint32_t second)
+     *  @brief Exchange the places of two IDs in the dense array.
+     *
+     *  Assert/undefined behavior if either index is out of range.
+     *  @param first Dense index of the first ID.
+     *  @param second Dense index of the second ID.
+     ***
+     *  @fn uint32_t SparseSet::size() const
+     *  @brief Get the amount of IDs in the set.
+     *  @return Amount of IDs.
+     ***
+     *  @fn const std::vector<uint32_t>& SparseSet::getIds() const
+     *  @brief Access the dense array of IDs.
+     *  @return Dense array.
+     ***
+     *  @fn void SparseSet::reserve(uint32_t amount)
+     *  @brief Reserve space in the dense array for a given amount of IDs.
+     *  @param amount Amount of IDs.
+     ***
+     *  @fn void SparseSet::clear()
+     *  @brief Remove all IDs.
+     ***
+     *  @fn uint64_t SparseSet::getReservedBytes() const
+     *  @brief Get the amount of memory allocated by the set.
+     *  @return Size in bytes.
+     ***/
+}
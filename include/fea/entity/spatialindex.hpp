@@ -0,0 +1,69 @@
+#pragma once
+#include <fea/config.hpp>
+#include <cstdint>
+#include <vector>
+#include <fea/assert.hpp>
+#include <fea/entity/attributeindex.hpp>
+#include <fea/util/loosentree.hpp>
+
+namespace fea
+{
+    template<class TreeType, class VectorType>
+    class SpatialIndex : public AttributeIndexBase
+    {
+        public:
+            using Type = VectorType;
+            using Tree = TreeType;
+
+            SpatialIndex(uint32_t positionAttribute, uint32_t sizeAttribute, const VectorType& bounds);
+            void update(EntityId id, const void* value, const void* secondaryValue) override;
+            void remove(uint32_t index) override;
+            void clear() override;
+            template<class Function>
+            void forEachInArea(const VectorType& start, const VectorType& end, Function function) const;
+            const TreeType& getTree() const;
+        private:
+            static typename TreeType::Vector toTreeVector(const VectorType& vector);
+            static bool equals(const VectorType& a, const VectorType& b);
+            TreeType mTree;
+            std::vector<VectorType> mPositions;
+            std::vector<VectorType> mSizes;
+            std::vector<EntityId> mIds;
+    };
+
+#include <fea/entity/spatialindex.inl>
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class SpatialIndex
+     *@}
+     ***
+     *  @class SpatialIndex
+     *  @brief Keeps the entities having a position and a size attribute in a LooseNTree, to find the entities overlapping an area.
+     *
+     *  The entity slot index is used as the ID in the tree. Like the other indexes, the tree is only updated for the entities whose position or size changed since the index was last used, so all movement of a frame is applied in one batch when the first query of the frame is made. Entities changing only position are moved within the tree, and entities changing size are re-added.
+     *
+     *  The position is the center of the entity and the size its full extent along every axis. Positions must stay within the bounds of the tree, and sizes must be larger than zero. Entities lacking either attribute are not indexed.
+     *  @tparam TreeType LooseNTree to use, such as QuadTree<8, false>.
+     *  @tparam VectorType Type of the position and size attributes. Must have one float coordinate per dimension of the tree accessible using operator[], like glm::vec2.
+     ***
+     *  @fn SpatialIndex::SpatialIndex(uint32_t positionAttribute, uint32_t sizeAttribute, const VectorType& bounds)
+     *  @brief Construct an empty index.
+     *  @param positionAttribute Index of the position attribute.
+     *  @param sizeAttribute Index of the size attribute.
+     *  @param bounds Size of the tree. Positions range from zero to this.
+     ***
+     *  @fn void SpatialIndex::forEachInArea(const VectorType& start, const VectorType& end, Function function) const
+     *  @brief Call a function for every entity overlapping a box, including entities touching its edges.
+     *
+     *  The possible overlaps returned by the tree are checked against the actual positions and sizes of the entities, so only real overlaps are visited, in no particular order.
+     *  @tparam Function Callable with the signature void(EntityId).
+     *  @param start Lowest corner of the box.
+     *  @param end Highest corner of the box.
+     *  @param function Function to call.
+     ***
+     *  @fn const TreeType& SpatialIndex::getTree() const
+     *  @brief Get the tree holding the entities. The IDs in the tree are entity slot indices.
+     *  @return The tree.
+     ***/
+}
@@ -0,0 +1,118 @@
+template<class TreeType, class VectorType>
+SpatialIndex<TreeType, VectorType>::SpatialIndex(uint32_t positionAttribute, uint32_t sizeAttribute, const VectorType& bounds) :
+    AttributeIndexBase(positionAttribute, typeid(VectorType), sizeAttribute),
+    mTree(toTreeVector(bounds))
+{
+}
+
+template<class TreeType, class VectorType>
+void SpatialIndex<TreeType, VectorType>::update(EntityId id, const void* value, const void* secondaryValue)
+{
+    uint32_t index = getEntityIndex(id);
+
+    if(!secondaryValue)
+    {
+        remove(index);
+        return;
+    }
+
+    const VectorType& position = *static_cast<const VectorType*>(value);
+    const VectorType& size = *static_cast<const VectorType*>(secondaryValue);
+
+    if(index >= mIds.size())
+    {
+        mPositions.resize(index + 1);
+        mSizes.resize(index + 1);
+        mIds.resize(index + 1, ~EntityId(0));
+    }
+
+    if(mIds[index] == id && equals(mSizes[index], size))
+    {
+        if(!equals(mPositions[index], position))
+            mTree.move(index, toTreeVector(position));
+    }
+    else
+    {
+        remove(index);
+        mTree.add(index, toTreeVector(position), toTreeVector(size));
+        mSizes[index] = size;
+        mIds[index] = id;
+    }
+
+    mPositions[index] = position;
+}
+
+template<class TreeType, class VectorType>
+void SpatialIndex<TreeType, VectorType>::remove(uint32_t index)
+{
+    if(index < mIds.size() && mIds[index] != ~EntityId(0))
+    {
+        mTree.remove(index);
+        mIds[index] = ~EntityId(0);
+    }
+}
+
+template<class TreeType, class VectorType>
+void SpatialIndex<TreeType, VectorType>::clear()
+{
+    mTree.clear();
+    mPositions.clear();
+    mSizes.clear();
+    mIds.clear();
+}
+
+template<class TreeType, class VectorType>
+template<class Function>
+void SpatialIndex<TreeType, VectorType>::forEachInArea(const VectorType& start, const VectorType& end, Function function) const
+{
+    for(typename TreeType::TreeEntry entry : mTree.get(toTreeVector(start), toTreeVector(end)))
+    {
+        uint32_t index = static_cast<uint32_t>(entry);
+        const VectorType& position = mPositions[index];
+        const VectorType& size = mSizes[index];
+        bool overlaps = true;
+
+        for(uint32_t d = 0; d < TreeType::dimensions; d++)
+        {
+            float halfSize = size[d] / 2.0f;
+
+            if(position[d] + halfSize < start[d] || position[d] - halfSize > end[d])
+            {
+                overlaps = false;
+                break;
+            }
+        }
+
+        if(overlaps)
+            function(mIds[index]);
+    }
+}
+
+template<class TreeType, class VectorType>
+const TreeType& SpatialIndex<TreeType, VectorType>::getTree() const
+{
+    return mTree;
+}
+
+template<class TreeType, class VectorType>
+typename TreeType::Vector SpatialIndex<TreeType, VectorType>::toTreeVector(const VectorType& vector)
+{
+    typename TreeType::Vector result;
+
+    for(uint32_t d = 0; d < TreeType::dimensions; d++)
+        result[d] = static_cast<float>(vector[d]);
+
+    return result;
+}
+
+template<class TreeType, class VectorType>
+bool SpatialIndex<TreeType, VectorType>::equals(const VectorType& a, const VectorType& b)
+{
+    for(uint32_t d = 0; d < TreeType::dimensions; d++)
+    {
+        if(a[d] != b[d])
+            return false;
+    }
+
+    return true;
+}
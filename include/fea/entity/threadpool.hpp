@@ -0,0 +1,128 @@
+#pragma once
+#include <fea/config.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fea
+{
+    class FEA_API ThreadPool
+    {
+        public:
+            class FEA_API TaskGroup
+            {
+                public:
+                    TaskGroup();
+                    TaskGroup(const TaskGroup&) = delete;
+                    TaskGroup& operator=(const TaskGroup&) = delete;
+                    bool isDone() const;
+                private:
+                    std::atomic<uint32_t> mPending;
+                friend class ThreadPool;
+            };
+
+            ThreadPool(uint32_t workerCount = getDefaultWorkerCount());
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+            ~ThreadPool();
+            uint32_t getWorkerCount() const;
+            void run(TaskGroup& group, std::function<void()> task);
+            void wait(TaskGroup& group);
+            template<class Function>
+            void parallelFor(uint32_t count, uint32_t grainSize, Function function);
+            static uint32_t getDefaultWorkerCount();
+        private:
+            struct Task
+            {
+                std::function<void()> mFunction;
+                TaskGroup* mGroup;
+            };
+
+            struct Queue
+            {
+                std::mutex mMutex;
+                std::deque<Task> mTasks;
+            };
+
+            uint32_t getCurrentQueue() const;
+            bool popTask(uint32_t queue, Task& task);
+            bool runTask(uint32_t queue);
+            void workerLoop(uint32_t queue);
+            std::vector<std::unique_ptr<Queue>> mQueues;
+            std::vector<std::thread> mWorkers;
+            std::atomic<uint32_t> mQueuedTasks;
+            std::mutex mSleepMutex;
+            std::condition_variable mSleepCondition;
+            bool mStop;
+    };
+
+#include <fea/entity/threadpool.inl>
+
+    /** @addtogroup EntitySystem
+     *@{
+     *  @class ThreadPool
+     *  @class ThreadPool::TaskGroup
+     *@}
+     ***
+     *  @class ThreadPool
+     *  @brief A work stealing pool of worker threads.
+     *
+     *  Every worker has its own task queue. Tasks run from within a task are pushed to the queue of the worker running it, and that worker takes tasks from the back of its own queue. Idle workers steal tasks from the front of the queues of other workers. Tasks run from threads outside of the pool go to a shared queue.
+     *
+     *  Tasks are tracked using TaskGroup instances. ThreadPool::wait returns when every task of a group has finished, and the waiting thread runs queued tasks while it waits instead of blocking. This means that waiting from within a task does not deadlock, and that a pool with zero workers still runs everything, on the waiting thread.
+     *
+     *  Used by the ControllerScheduler and EntityQuery::forEachParallel.
+     ***
+     *  @class ThreadPool::TaskGroup
+     *  @brief Keeps track of a set of tasks running on a ThreadPool.
+     *
+     *  A group must outlive its tasks, which is guaranteed by calling ThreadPool::wait before the group goes out of scope.
+     ***
+     *  @fn ThreadPool::TaskGroup::TaskGroup()
+     *  @brief Construct an empty group.
+     ***
+     *  @fn bool ThreadPool::TaskGroup::isDone() const
+     *  @brief Check if all tasks of the group have finished.
+     *  @return True if no tasks are pending.
+     ***
+     *  @fn ThreadPool::ThreadPool(uint32_t workerCount = getDefaultWorkerCount())
+     *  @brief Construct a pool and start its workers.
+     *  @param workerCount Amount of worker threads to start.
+     ***
+     *  @fn ThreadPool::~ThreadPool()
+     *  @brief Stop and join all workers. Queued tasks are finished first.
+     ***
+     *  @fn uint32_t ThreadPool::getWorkerCount() const
+     *  @brief Get the amount of worker threads.
+     *  @return Amount of workers.
+     ***
+     *  @fn void ThreadPool::run(TaskGroup& group, std::function<void()> task)
+     *  @brief Queue a task.
+     *  @param group Group the task belongs to.
+     *  @param task Task to run.
+     ***
+     *  @fn void ThreadPool::wait(TaskGroup& group)
+     *  @brief Wait until all tasks of a group have finished, running queued tasks in the meantime.
+     *  @param group Group to wait for.
+     ***
+     *  @fn void ThreadPool::parallelFor(uint32_t count, uint32_t grainSize, Function function)
+     *  @brief Split a range into batches and process them in parallel.
+     *
+     *  Returns when all batches are done.
+     *  @tparam Function Callable with the signature void(uint32_t begin, uint32_t end).
+     *  @param count Size of the range.
+     *  @param grainSize Maximum size of every batch.
+     *  @param function Function to call for every batch.
+     ***
+     *  @fn static uint32_t ThreadPool::getDefaultWorkerCount()
+     *  @brief Get the default amount of workers, which is one less than the amount of hardware threads since the thread calling ThreadPool::wait takes part in the work.
+     *  @return Amount of workers.
+     ***/
+}
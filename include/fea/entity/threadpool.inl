@@ -0,0 +1,25 @@
+template<class Function>
+void ThreadPool::parallelFor(uint32_t count, uint32_t grainSize, Function function)
+{
+    grainSize = std::max(grainSize, 1u);
+
+    if(count <= grainSize || mWorkers.empty())
+    {
+        if(count > 0)
+            function(0u, count);
+        return;
+    }
+
+    TaskGroup group;
+
+    for(uint32_t begin = 0; begin < count; begin += grainSize)
+    {
+        uint32_t end = std::min(begin + grainSize, count);
+        run(group, [&function, begin, end] ()
+        {
+            function(begin, end);
+        });
+    }
+
+    wait(group);
+}
@@ -1,7 +1,10 @@
 #include <fea/entity/basictypeadder.hpp>
 #include <fea/entity/entity.hpp>
+#include <fea/entity/entityhandle.hpp>
 #include <fea/entity/entityfactory.hpp>
+#include <fea/entity/entitycommandbuffer.hpp>
 #include <fea/entity/entitycontroller.hpp>
+#include <fea/entity/controllerscheduler.hpp>
 // jsonentityloader.hpp is built conditionally,
 // so including this would result in an error when
 // Feather Kit has been built with BUILD_JSON=FALSE
@@ -1,7 +1,9 @@
 #pragma once
+#include <cmath>
 #include <set>
 #include <sstream>
 #include <unordered_map>
+#include <vector>
 #include <fea/assert.hpp>
 
 namespace fea
@@ -19,6 +21,7 @@ namespace fea
     template<uint32_t Dimensions, uint32_t Depth, bool StaticAllocation>
     class LooseNTree
     {
+        public:
             class Vector
             {
                 public:
@@ -31,12 +34,12 @@ namespace fea
                     Vector operator*(float multiplier) const;
                     Vector operator/(const Vector& other) const;
                     Vector operator/(float divisor) const;
-                    Vector& operator=(const Vector& other);
                     bool isPositive() const;
                 private:
                     float mCoords[Dimensions];
             };
 
+        private:
             struct Node
             {
                 Node();
@@ -46,6 +49,7 @@ namespace fea
 
         public:
             using TreeEntry = size_t;
+            static const uint32_t dimensions = Dimensions;
 
             LooseNTree(const Vector& size);
             void add(uint32_t id, const Vector& position, const Vector& size);
@@ -86,6 +90,7 @@ namespace fea
     /** @addtogroup Util
      *@{
      *  @typedef LooseNTree::TreeEntry
+     *  @class LooseNTree::Vector
      *  @typedef QuadTree
      *  @typedef Octree
      *  @class LooseNTree
@@ -94,6 +99,12 @@ namespace fea
      *  @typedef LooseNTree::TreeEntry
      *  @brief An entry in the tree.
      ***
+     *  @class LooseNTree::Vector
+     *  @brief Position or size in the space of the tree, with one coordinate per dimension. Can be constructed from an initializer list, like {x, y} for a QuadTree.
+     ***
+     *  @var LooseNTree::dimensions
+     *  @brief Amount of dimensions of the tree.
+     ***
      *  @typedef QuadTree
      *  @brief Tree structure for keeping track of possibly overlapping objects in 2-dimensional space.
      ***
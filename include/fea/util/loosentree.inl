@@ -76,14 +76,6 @@ typename LooseNTree<Dimensions, Depth, StaticAllocation>::Vector LooseNTree<Dime
     return result;
 }
 
-template<uint32_t Dimensions, uint32_t Depth, bool StaticAllocation>
-typename LooseNTree<Dimensions, Depth, StaticAllocation>::Vector& LooseNTree<Dimensions, Depth, StaticAllocation>::Vector::operator=(const Vector& other)
-{
-    for(uint32_t d = 0; d < Dimensions; d++)
-        mCoords[d] = other.mCoords[d];
-    return *this;
-}
-
 template<uint32_t Dimensions, uint32_t Depth, bool StaticAllocation>
 bool LooseNTree<Dimensions, Depth, StaticAllocation>::Vector::isPositive() const
 {
@@ -151,19 +143,16 @@ void LooseNTree<Dimensions, Depth, StaticAllocation>::add(uint32_t id, const Vec
         FEA_ASSERT(position[dim]  >= 0.0f && position[dim] <= mSize[dim], "Trying to add object outside of the bounds of the tree!");
     }
 
-    uint32_t depth;
+    //place the object in the deepest node which is at least as large as the object, so that it fits in the loose bounds
+    uint32_t depth = 0;
 
-    Vector nextLooseBounds = mSize;
-    for(depth = 0; depth < Depth; depth++)
+    Vector nextNodeSize = mSize / 2.0f;
+    while(depth + 1 < Depth && size <= nextNodeSize)
     {
-        if(!(size <= nextLooseBounds))
-        {
-            depth++; //one too much
-            break;
-        }
-        nextLooseBounds = nextLooseBounds / 2.0f;
+        depth++;
+        nextNodeSize = nextNodeSize / 2.0f;
     }
-    placeTreeEntryInDepth(id, position, depth - 1); //correct it
+    placeTreeEntryInDepth(id, position, depth);
 }
 
 template<uint32_t Dimensions, uint32_t Depth, bool StaticAllocation>
@@ -182,7 +171,7 @@ void LooseNTree<Dimensions, Depth, StaticAllocation>::remove(uint32_t id)
             nodesToCheck.push_back(currentNode);
             currentNode = mNodes[currentNode].mParent;
         }
-        for(int32_t i = 0; i < nodesToCheck.size(); i++)
+        for(uint32_t i = 0; i < nodesToCheck.size(); i++)
         {
             checkForRemoval(nodesToCheck[i], nodesToCheck);
         }
@@ -222,7 +211,7 @@ void LooseNTree<Dimensions, Depth, StaticAllocation>::move(uint32_t id, const Ve
             nodesToCheck.push_back(currentNode);
             currentNode = mNodes[currentNode].mParent;
         }
-        for(int32_t i = 0; i < nodesToCheck.size(); i++)
+        for(uint32_t i = 0; i < nodesToCheck.size(); i++)
         {
             checkForRemoval(nodesToCheck[i], nodesToCheck);
         }
@@ -316,14 +305,12 @@ template<uint32_t Dimensions, uint32_t Depth, bool StaticAllocation>
 void LooseNTree<Dimensions, Depth, StaticAllocation>::removeTreeEntry(uint32_t id)
 {
     auto range = mEntries.equal_range(mEntryLocations.at(id));
-    bool existed = false;
 
     for(auto iter = range.first; iter != range.second; iter++)
     {
         if(iter->second == id)
         {
             mEntries.erase(iter);
-            existed = true;
             break;
         }
     }
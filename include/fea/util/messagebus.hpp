@@ -1,15 +1,71 @@
 #pragma once
 #include <fea/config.hpp>
+#include <atomic>
 #include <vector>
-#include <unordered_map>
 #include <sstream>
-#include <typeindex>
+#include <typeinfo>
 #include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <fea/assert.hpp>
+#include <fea/util/messagebusconfig.hpp>
 #include <fea/util/messagereceiver.hpp>
+#include <fea/util/messagestats.hpp>
 
 namespace fea
 {
+    FEA_API uint32_t nextMessageTypeId();
+
+    template<class Message>
+    struct MessageTypeInfo
+    {
+        static uint32_t getId();
+        static std::atomic<uint32_t> subscriptionCount;
+    };
+
+    template<class Message>
+    struct SubscriptionToken
+    {
+        uint32_t mSlot;
+        uint32_t mGeneration;
+    };
+
+    class FEA_API MessageQueueBase
+    {
+        public:
+            MessageQueueBase(uint32_t typeId);
+            virtual ~MessageQueueBase();
+            uint32_t getTypeId() const;
+            virtual const char* getTypeName() const = 0;
+            virtual MessageQueueBase* createQueue() const = 0;
+            virtual void moveTo(MessageQueueBase& target) = 0;
+            virtual bool isEmpty() const = 0;
+            virtual uint32_t getCount() const = 0;
+            virtual void deliver(MessageReceiverBase& receiver) const = 0;
+            virtual void clear() = 0;
+        private:
+            uint32_t mTypeId;
+    };
+
+    template<class Message>
+    class MessageQueue : public MessageQueueBase
+    {
+        public:
+            MessageQueue();
+            void post(const Message& message);
+            const char* getTypeName() const override;
+            MessageQueueBase* createQueue() const override;
+            void moveTo(MessageQueueBase& target) override;
+            bool isEmpty() const override;
+            uint32_t getCount() const override;
+            void deliver(MessageReceiverBase& receiver) const override;
+            void clear() override;
+        private:
+            std::vector<Message> mMessages;
+    };
+
     class FEA_API MessageBus
     {
         public:
@@ -17,30 +73,114 @@ namespace fea
             MessageBus(const MessageBus&) = delete;
             MessageBus& operator=(const MessageBus&) = delete;
             template<class Message>
-            void addSubscriber(const MessageReceiverSingle<Message>& receiver);
+            SubscriptionToken<Message> addSubscriber(const MessageReceiverSingle<Message>& receiver, bool threadSafe = false, int32_t priority = 0);
             template<class Message>
             void removeSubscriber(const MessageReceiverSingle<Message>& receiver);
             template<class Message>
+            void removeSubscriber(SubscriptionToken<Message> token);
+            template<class Message>
             void send(const Message& mess);
+            template<class Message>
+            void post(const Message& message);
+            void dispatch();
+            template<class Pool>
+            void dispatch(Pool& threadPool);
+#if defined(FEA_MESSAGE_STATS)
+            void getStats(std::vector<MessageTypeStats>& stats) const;
+            void resetStats();
+#endif
         private:
-            bool subscriptionExists(std::type_index id, MessageReceiverBase* receiver) const;
-            std::unordered_map<std::type_index, std::vector<MessageReceiverBase*>> mSubscribers;
+            struct Subscription
+            {
+                MessageReceiverBase* mReceiver;
+                int32_t mPriority;
+                bool mThreadSafe;
+                uint32_t mSlot;
+            };
+
+            struct Slot
+            {
+                uint32_t mPosition;
+                uint32_t mGeneration;
+                bool mPending;
+            };
+
+            struct SubscriberList
+            {
+                SubscriberList();
+                std::vector<Subscription> mSubscriptions;
+                std::vector<Subscription> mPending;
+                std::vector<Slot> mSlots;
+                std::vector<uint32_t> mFreeSlots;
+                uint32_t mDeliveries;
+                uint32_t mRemovedCount;
+            };
+
+            struct PostQueues
+            {
+                std::thread::id mThread;
+                std::mutex mMutex;
+                std::vector<std::unique_ptr<MessageQueueBase>> mQueues;
+            };
+
+            struct Delivery
+            {
+                const MessageQueueBase* mQueue;
+                MessageReceiverBase* mReceiver;
+                uint32_t mPosition;
+#if defined(FEA_MESSAGE_STATS)
+                uint64_t mNanoseconds;
+#endif
+            };
+
+            uint32_t addSubscription(uint32_t typeId, const char* typeName, MessageReceiverBase* receiver, bool threadSafe, int32_t priority, uint32_t& generation);
+            bool removeSubscription(uint32_t typeId, const char* typeName, MessageReceiverBase* receiver);
+            bool removeSubscription(uint32_t typeId, uint32_t slot, uint32_t generation);
+            void removeSlot(SubscriberList& list, uint32_t slot);
+            void insertSubscription(SubscriberList& list, const Subscription& subscription);
+            void compact(SubscriberList& list);
+            void endDelivery(SubscriberList& list);
+            PostQueues& getPostQueues();
+            void collectPosted();
+            void gatherThreadSafeDeliveries();
+            void deliverThreadSafe(uint32_t begin, uint32_t end);
+            void finishThreadSafeDeliveries();
+            void deliverPosted(bool skipThreadSafe);
+            bool isDispatching() const;
+#if defined(FEA_MESSAGE_STATS)
+            void recordMessages(uint32_t typeId, const char* typeName, uint32_t sendCount, uint32_t postCount);
+            void recordFanOut(uint32_t typeId, uint32_t fanOut);
+            void recordHandlerCall(uint32_t typeId, std::chrono::high_resolution_clock::time_point start);
+            void recordHandlerCall(uint32_t typeId, uint64_t nanoseconds);
+#endif
+            uint64_t mInstance;
+            std::mutex mDispatchMutex;
+            mutable std::recursive_mutex mSubscribersMutex;
+            std::vector<SubscriberList> mSubscribers;
+            std::mutex mPostQueuesMutex;
+            std::vector<std::unique_ptr<PostQueues>> mPostQueues;
+            std::vector<std::unique_ptr<MessageQueueBase>> mQueues;
+            std::vector<uint32_t> mQueueIndices;
+            std::vector<Delivery> mThreadSafeDeliveries;
+#if defined(FEA_MESSAGE_STATS)
+            std::vector<MessageTypeStats> mStats;
+#endif
     };
 
     template <class MessageType>
-    void subscribeToType(MessageBus& bus, MessageReceiverSingle<MessageType>& receiver, std::vector<std::function<void()>>& desubscribers, bool unsubscribe)
+    void subscribeToType(MessageBus& bus, MessageReceiverSingle<MessageType>& receiver, std::vector<std::function<void()>>& desubscribers, bool unsubscribe, bool threadSafe, int32_t priority)
     {
-        bus.addSubscriber<MessageType>(receiver);
+        SubscriptionToken<MessageType> token = bus.addSubscriber<MessageType>(receiver, threadSafe, priority);
 
         if(unsubscribe)
-            desubscribers.push_back([&] () { bus.removeSubscriber<MessageType>(receiver);});
+            desubscribers.push_back([&bus, token] () { bus.removeSubscriber(token);});
     }
 
     template<class... MessageTypes>
-    void subscribe(MessageBus& bus, MessageReceiver<MessageTypes...>& receiver, bool unsubscribe)
+    void subscribe(MessageBus& bus, MessageReceiver<MessageTypes...>& receiver, bool unsubscribe, bool threadSafe, int32_t priority)
     {
         std::vector<std::function<void()>> desubscribers;
-        int _[] = {(subscribeToType<MessageTypes>(bus, receiver, desubscribers, unsubscribe), 0)...};
+        int _[] = {(subscribeToType<MessageTypes>(bus, receiver, desubscribers, unsubscribe, threadSafe, priority), 0)...};
         (void)_;
         receiver.mDesubscribers = desubscribers;
     }
@@ -48,8 +188,13 @@ namespace fea
 #include <fea/util/messagebus.inl>
     /** @addtogroup Util
      *@{
+     *  @class MessageTypeInfo
+     *  @fn uint32_t nextMessageTypeId()
+     *  @class SubscriptionToken
+     *  @class MessageQueueBase
+     *  @class MessageQueue
      *  @class MessageBus
-     *  @fn void subscribe(MessageBus& bus, MessageReceiver<MessageTypes...>& receiver, bool unsubscribe = true)
+     *  @fn void subscribe(MessageBus& bus, MessageReceiver<MessageTypes...>& receiver, bool unsubscribe = true, bool threadSafe = false, int32_t priority = 0)
      *@}
      ***
      *  @class MessageBus
@@ -57,8 +202,91 @@ namespace fea
      *
      *  It offers a way of subscribing to messages. It will keep track of the subscriptions and when messages are send, it will reroute these to the correct receivers.
      *  The type of the message can be anything. Even primitives like int or double can be subscribed to. Most of the time, the message type is a struct carrying the information needed.
+     *
+     *  Messages can either be sent, which delivers them right away from within the call to MessageBus::send, or posted, which queues them until MessageBus::dispatch is called. Posting suits messages that come in bursts in the middle of other work, like collisions found during a physics step, since the subscribers then run later, one message type at a time, instead of being interleaved with the work that produced the messages.
+     *
+     *  All functions may be called from any thread. Every thread posts into queues of its own, so threads posting at the same time never wait for each other; they only wait for the brief moment a dispatch collects their queues. Sending, dispatching and changing subscriptions share a lock, so handlers of sent and dispatched messages run on one thread at a time, except for handlers of subscribers marked thread-safe, which MessageBus::dispatch(Pool&) runs in parallel without holding the lock. Subscriptions may be added and removed at any time, also from handlers while messages are being delivered, including thread-safe handlers running on a thread pool. Receivers unsubscribed during a delivery receive nothing more. Removal waits for deliveries to subscribers which are not thread-safe running on other threads, so such a receiver may unsubscribe and be destroyed as soon as the removal returns. A thread-safe subscriber may however still be in one of its handlers on the thread pool, so unless it removes itself from within its own handler, it must not be destroyed before MessageBus::dispatch(Pool&) returns.
+     *
+     *  Subscribers are called in order of priority, and subscribers of equal priority in the order they subscribed. Removing a subscription using the SubscriptionToken returned when subscribing takes constant time, which keeps scenes with many short lived receivers cheap.
+     *
+     *  When the library is built with the MESSAGE_STATS CMake option, the bus records how many messages of each type pass through it and how long their handlers take. See MessageBus::getStats. The option defines FEA_MESSAGE_STATS in the generated and installed header fea/util/messagebusconfig.hpp, so code using the bus always sees the same MessageBus as the library. Without the option, none of the recording is compiled. With it, MessageBus::send takes the lock even for message types nothing subscribes to, so that those are counted too.
+     ***
+     *  @fn uint32_t nextMessageTypeId()
+     *  @brief Hand out a new message type ID. Used by MessageTypeInfo::getId.
+     *  @return The next unused ID, starting from zero.
+     ***
+     *  @class MessageTypeInfo
+     *  @brief Per message type data used by the MessageBus.
+     *
+     *  Message types are numbered in the order they are first used, which lets the MessageBus keep subscribers and queues in arrays indexed by type instead of hash tables keyed by std::type_index. On platforms where every shared library instantiates templates of its own, the same type may get different IDs in different libraries, so messages of a type should only be sent and subscribed to from one library.
+     *  @tparam Message Message type.
+     ***
+     *  @fn static uint32_t MessageTypeInfo::getId()
+     *  @brief Get the ID of the message type, handing out a new one on the first call.
+     *  @return ID of the message type.
+     ***
+     *  @var MessageTypeInfo::subscriptionCount
+     *  @brief Amount of subscriptions to the message type, summed over all message buses. MessageBus::send returns right away without taking any lock when this is zero, unless the library is built with the MESSAGE_STATS CMake option, in which case every sent message is counted under the lock.
+     ***
+     *  @class SubscriptionToken
+     *  @brief Identifies a subscription created by MessageBus::addSubscriber, for removing it using MessageBus::removeSubscriber(SubscriptionToken<Message>).
+     *  @tparam Message Message type of the subscription.
      ***
-     *  @fn void MessageBus::addSubscriber(const MessageReceiver<Message>& receiver)
+     *  @var SubscriptionToken::mSlot
+     *  @brief Slot of the subscription in the list of subscribers to the message type.
+     ***
+     *  @var SubscriptionToken::mGeneration
+     *  @brief Times the slot had been reused when the subscription was created, telling the subscription apart from later ones in the same slot.
+     ***
+     *  @class MessageQueueBase
+     *  @brief Type erased base of MessageQueue, letting the MessageBus dispatch all queues without knowing their message types.
+     ***
+     *  @fn MessageQueueBase::MessageQueueBase(uint32_t typeId)
+     *  @brief Construct a queue for a message type.
+     *  @param typeId MessageTypeInfo ID of the queued messages.
+     ***
+     *  @fn uint32_t MessageQueueBase::getTypeId() const
+     *  @brief Get the type of the queued messages.
+     *  @return MessageTypeInfo ID of the message type.
+     ***
+     *  @fn virtual const char* MessageQueueBase::getTypeName() const = 0
+     *  @brief Get the name of the type of the queued messages, as given by std::type_info::name.
+     *  @return Mangled type name.
+     ***
+     *  @fn virtual MessageQueueBase* MessageQueueBase::createQueue() const = 0
+     *  @brief Create an empty queue for the same message type.
+     *  @return Heap allocated queue, owned by the caller.
+     ***
+     *  @fn virtual void MessageQueueBase::moveTo(MessageQueueBase& target) = 0
+     *  @brief Move all messages to the end of another queue of the same message type, leaving this queue empty.
+     *  @param target Queue to move the messages to.
+     ***
+     *  @fn virtual bool MessageQueueBase::isEmpty() const = 0
+     *  @brief Check if the queue holds no messages.
+     *  @return True if empty.
+     ***
+     *  @fn virtual uint32_t MessageQueueBase::getCount() const = 0
+     *  @brief Get the amount of queued messages.
+     *  @return Message count.
+     ***
+     *  @fn virtual void MessageQueueBase::deliver(MessageReceiverBase& receiver) const = 0
+     *  @brief Hand all messages to a subscriber as one batch. Several threads may deliver the same queue at once.
+     *  @param receiver Subscriber to the message type.
+     ***
+     *  @fn virtual void MessageQueueBase::clear() = 0
+     *  @brief Discard all messages, keeping the allocated memory.
+     ***
+     *  @class MessageQueue
+     *  @brief Queue of the messages of one type posted to a MessageBus.
+     *
+     *  The messages are stored by value in a contiguous array, which keeps its capacity between dispatches so that posting does not allocate once the queue has grown to the size of a typical burst.
+     *  @tparam Message Type of the queued messages.
+     ***
+     *  @fn void MessageQueue::post(const Message& message)
+     *  @brief Add a copy of a message to the end of the queue.
+     *  @param message Message to add.
+     ***
+     *  @fn SubscriptionToken<Message> MessageBus::addSubscriber(const MessageReceiver<Message>& receiver, bool threadSafe = false, int32_t priority = 0)
      *  @brief Create a subscription for a receiver.
      *  
      *  The subscription will be valid until MessageBus::removeMessageSubscriber is called on the same receiver. The Message type subscribed to is the one given in the template argument. The receiver must inherit from the correct MessageReceiver to be able to subscribe to a message. If the subscriber is destroyed before the MessageBus, all of its subscriptions must be removed using MessageBus::removeMessageSubscriber.
@@ -66,6 +294,9 @@ namespace fea
      *  Assert/undefined behavior if an object tries to subscribe to the same Message type more than once.
      *  @tparam Message Type of the message to subscribe to.
      *  @param receiver The instance which will receive the messages.
+     *  @param threadSafe Set this to let MessageBus::dispatch(Pool&) deliver posted messages to the receiver on the threads of a thread pool. Such a receiver must handle its messages being delivered at the same time as other messages, including messages of its other types. Its handlers may post and send messages and change subscriptions while running on the pool, but must not dispatch.
+     *  @param priority Subscribers with higher priorities are called first. A subscription added while the message type is being delivered takes its place once the delivery is done, and does not receive the messages being delivered.
+     *  @return Token for removing the subscription in constant time.
      ***
      *  @fn void MessageBus::removeSubscriber(const MessageReceiver<Message>& receiver)
      *  @brief Remove a Message subscription.
@@ -74,24 +305,94 @@ namespace fea
      *
      *  Assert/undefined behavior if the subscription to remove doesn't exist.
      *
+     *  This searches the subscribers to the message type for the receiver. Prefer MessageBus::removeSubscriber(SubscriptionToken<Message>) when there are many subscribers.
+     *
      *  @tparam Message The Message type to unsubscribe from.
      *  @param receiver Object to remove subscription for.
      ***
+     *  @fn void MessageBus::removeSubscriber(SubscriptionToken<Message> token)
+     *  @brief Remove a Message subscription in constant time.
+     *
+     *  The subscription is only marked as removed, so receivers may unsubscribe from within their own handlers. Removed subscriptions are erased in one pass once they make up half of the subscribers to the message type and no delivery of it is in progress.
+     *
+     *  Nothing happens if the subscription was already removed, for instance using MessageBus::removeSubscriber(const MessageReceiver<Message>&), even if another receiver has subscribed since.
+     *  @tparam Message The Message type to unsubscribe from.
+     *  @param token Token returned by MessageBus::addSubscriber.
+     ***
      *  @fn void MessageBus::send(const Message& mess)
      *  @brief Send a Message.
      *
-     *  Messages sent using this function will be routed to any subscribers which subscribed to that particular message type. If there are no subscribers to a particular Message type, nothing will hapen.
+     *  Messages sent using this function will be routed to any subscribers which subscribed to that particular message type. If there are no subscribers to a particular Message type, nothing will hapen. The subscribers are found by indexing an array with the MessageTypeInfo ID, and a message type nothing subscribes to costs a single atomic load.
      *  @tparam Message Type of the Message to send.
      *  @param mess Message instance to send.
      ***
-     *  @fn void subscribe(MessageBus& bus, MessageReceiver<MessageTypes...>& receiver, bool unsubscribe = true)
+     *  @fn void MessageBus::post(const Message& message)
+     *  @brief Queue a Message to be delivered by the next call to MessageBus::dispatch.
+     *
+     *  The message is copied into a contiguous queue holding the messages of its type posted from the calling thread. Any thread may post, also while another thread dispatches.
+     *  @code
+     *  for(const auto& contact : contacts)
+     *      bus.post(DamageMessage{contact.target, contact.impulse * damageFactor});
+     *  ...
+     *  bus.dispatch();
+     *  @endcode
+     *  @tparam Message Type of the Message to post. Must be copy constructible.
+     *  @param message Message instance to post.
+     ***
+     *  @fn void MessageBus::dispatch()
+     *  @brief Deliver all posted messages.
+     *
+     *  The message types are dispatched in the order they were first posted in. All queued messages of a type are handed to each subscriber to that type in turn, in order of priority, through MessageReceiver::handleMessages, in the order they were posted. Messages of a type posted from the same thread keep their order, and the messages of each thread are delivered one thread after the other. Messages without any subscribers when they are dispatched are discarded. Messages posted while dispatching, for instance by subscribers, are kept until the next call, so a dispatch always finishes.
+     *
+     *  The subscribers run on the calling thread. Only one dispatch runs at a time and the function must not be called from a handler. Calling it from a handler of a dispatched message asserts.
+     ***
+     *  @fn void MessageBus::dispatch(Pool& threadPool)
+     *  @brief Deliver all posted messages, using a thread pool for subscribers marked thread-safe.
+     *
+     *  Works like MessageBus::dispatch(), except that every subscriber which was marked thread-safe in MessageBus::addSubscriber first receives its messages as a separate task on the thread pool. Once those have all finished, the remaining subscribers receive their messages on the calling thread. Priorities only order the subscribers within each of these two groups.
+     *
+     *  The bus is not locked while the thread pool delivers, so thread-safe handlers may send messages and add and remove subscriptions, also their own, without waiting for the calling thread. A subscriber removed before its task starts receives nothing, and subscriptions added meanwhile to message types being delivered on the pool take their place once the dispatch is done. Calling MessageBus::dispatch from a handler running on the thread pool asserts, since the dispatch in progress waits for that handler.
+     *  @code
+     *  fea::ThreadPool threadPool;
+     *  fea::subscribe(bus, pathfinder, true, true);
+     *  ...
+     *  bus.dispatch(threadPool);
+     *  @endcode
+     *  @tparam Pool Type of the thread pool. It must provide parallelFor(uint32_t count, uint32_t grainSize, Function function) calling function(begin, end) on ranges covering [0, count) and returning when all calls are done, like ThreadPool in the entity module.
+     *  @param threadPool Thread pool to deliver messages on.
+     ***
+     *  @fn void MessageBus::getStats(std::vector<MessageTypeStats>& stats) const
+     *  @brief Get the message traffic since the statistics were last reset. Only available when the library is built with the MESSAGE_STATS CMake option.
+     *
+     *  Every message type which has been sent or dispatched since the last reset gets an entry. Calling this and MessageBus::resetStats once per frame gives the traffic of every frame, which makes bursts of messages easy to spot.
+     *  @code
+     *  std::vector<fea::MessageTypeStats> stats;
+     *  bus.getStats(stats);
+     *  bus.resetStats();
+     *
+     *  for(const auto& type : stats)
+     *  {
+     *      if(type.mHandlerNanoseconds > 1000000)
+     *          std::cout << type.mName << ": " << type.mSendCount + type.mPostCount << " messages took " << type.mHandlerNanoseconds / 1000 << " us\n";
+     *  }
+     *  @endcode
+     *  @param stats Vector to fill with the statistics, ordered by MessageTypeInfo ID. Previous content is discarded.
+     ***
+     *  @fn void MessageBus::resetStats()
+     *  @brief Set all recorded counts and times to zero. Only available when the library is built with the MESSAGE_STATS CMake option.
+     ***
+     *  @fn void subscribe(MessageBus& bus, MessageReceiver<MessageTypes...>& receiver, bool unsubscribe = true, bool threadSafe = false, int32_t priority = 0)
      *  @brief Subscribe to all messages for a receiver in a RAII manner.
      *
-     *  When this function is called on a receiver, the receiver will be subscribed to all messages it is able to receive. Futhermore, upon destruction, all subscriptions will be cancelled unless automatic unsubscription is switched off.
+     *  When this function is called on a receiver, the receiver will be subscribed to all messages it is able to receive. Futhermore, upon destruction, all subscriptions will be cancelled unless automatic unsubscription is switched off. The subscriptions are removed using their SubscriptionToken, so destroying a receiver takes constant time per message type.
+     *
+     *  Automatic unsubscription happens in the destructor of MessageReceiver, after the destructors of derived classes have run. A receiver which may be delivered messages on another thread while it is being destroyed must therefore be unsubscribed before its destruction begins.
      *
      *  @param bus Message bus which messages to subscribe to.
      *  @param receiver Instance to receive messages.
      *  @param unsubscribe Set this to false to disable automatic unsubscription
+     *  @param threadSafe Mark the subscriptions as thread-safe, see MessageBus::addSubscriber.
+     *  @param priority Priority of the subscriptions, see MessageBus::addSubscriber.
      *  @tparam Message types to subscribe to.
      **/
 }
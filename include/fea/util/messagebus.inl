@@ -1,50 +1,186 @@
 template<class Message>
-void MessageBus::addSubscriber(const MessageReceiverSingle<Message>& receiver)
+uint32_t MessageTypeInfo<Message>::getId()
 {
-    MessageReceiverBase* receiverPtr = (MessageReceiverBase*) &receiver;
-    std::type_index index = std::type_index(typeid(Message));
+    static const uint32_t id = nextMessageTypeId();
+    return id;
+}
+
+template<class Message>
+std::atomic<uint32_t> MessageTypeInfo<Message>::subscriptionCount(0);
 
-    FEA_ASSERT(!subscriptionExists(index, receiverPtr), "Message receiver already subscribes to message " + std::string(index.name()) + "!");
-    mSubscribers[index].push_back(receiverPtr);
+template<class Message>
+MessageQueue<Message>::MessageQueue() : MessageQueueBase(MessageTypeInfo<Message>::getId())
+{
 }
 
 template<class Message>
-void MessageBus::removeSubscriber(const MessageReceiverSingle<Message>& receiver)
+void MessageQueue<Message>::post(const Message& message)
+{
+    mMessages.push_back(message);
+}
+
+template<class Message>
+const char* MessageQueue<Message>::getTypeName() const
 {
-    MessageReceiverBase* receiverPtr = (MessageReceiverBase*) &receiver;
-    std::type_index index = std::type_index(typeid(Message));
+    return typeid(Message).name();
+}
 
-    FEA_ASSERT(mSubscribers.find(index) != mSubscribers.end(), "Cannot remove subscription to message " + std::string(index.name()) + " since the subscription does not exist!");
+template<class Message>
+MessageQueueBase* MessageQueue<Message>::createQueue() const
+{
+    return new MessageQueue<Message>();
+}
 
-    auto& list = mSubscribers.at(index);
-    bool existed = false;
+template<class Message>
+void MessageQueue<Message>::moveTo(MessageQueueBase& target)
+{
+    std::vector<Message>& messages = static_cast<MessageQueue<Message>&>(target).mMessages;
 
-    for(auto iter = list.begin(); iter != list.end(); iter++)
+    //the buffers are swapped rather than moved when possible so that both keep their capacity
+    if(messages.empty())
     {
-        if(*iter == receiverPtr)
-        {
-            list.erase(iter);
-            existed = true;
-            if(list.size() == 0)
-                mSubscribers.erase(index);
-            break;
-        }
+        messages.swap(mMessages);
     }
+    else
+    {
+        messages.insert(messages.end(), std::make_move_iterator(mMessages.begin()), std::make_move_iterator(mMessages.end()));
+        mMessages.clear();
+    }
+}
+
+template<class Message>
+bool MessageQueue<Message>::isEmpty() const
+{
+    return mMessages.empty();
+}
+
+template<class Message>
+uint32_t MessageQueue<Message>::getCount() const
+{
+    return static_cast<uint32_t>(mMessages.size());
+}
+
+template<class Message>
+void MessageQueue<Message>::deliver(MessageReceiverBase& receiver) const
+{
+    static_cast<MessageReceiverSingle<Message>&>(receiver).handleMessages(mMessages);
+}
+
+template<class Message>
+void MessageQueue<Message>::clear()
+{
+    mMessages.clear();
+}
+
+template<class Message>
+SubscriptionToken<Message> MessageBus::addSubscriber(const MessageReceiverSingle<Message>& receiver, bool threadSafe, int32_t priority)
+{
+    SubscriptionToken<Message> token;
+    token.mSlot = addSubscription(MessageTypeInfo<Message>::getId(), typeid(Message).name(), (MessageReceiverBase*) &receiver, threadSafe, priority, token.mGeneration);
+    MessageTypeInfo<Message>::subscriptionCount++;
+    return token;
+}
+
+template<class Message>
+void MessageBus::removeSubscriber(const MessageReceiverSingle<Message>& receiver)
+{
+    if(removeSubscription(MessageTypeInfo<Message>::getId(), typeid(Message).name(), (MessageReceiverBase*) &receiver))
+        MessageTypeInfo<Message>::subscriptionCount--;
+}
 
-    FEA_ASSERT(existed, "Cannot remove subscription to message " + std::string(index.name()) + " since the subscription does not exist!");
+template<class Message>
+void MessageBus::removeSubscriber(SubscriptionToken<Message> token)
+{
+    if(removeSubscription(MessageTypeInfo<Message>::getId(), token.mSlot, token.mGeneration))
+        MessageTypeInfo<Message>::subscriptionCount--;
 }
 
 template<class Message>
 void MessageBus::send(const Message& mess)
 {
-    const auto listIterator = mSubscribers.find(std::type_index(typeid(Message)));
-    if(listIterator != mSubscribers.end())
+#if defined(FEA_MESSAGE_STATS)
+    //every send is counted, also of messages nobody listens to, so the fast exit below is left out and the lock is always taken
+    uint32_t id = MessageTypeInfo<Message>::getId();
+    std::lock_guard<std::recursive_mutex> lock(mSubscribersMutex);
+    recordMessages(id, typeid(Message).name(), 1, 0);
+#else
+    //the count covers all buses, so it only tells whether anything subscribes at all, but that lets messages nobody listens to skip the lock
+    if(MessageTypeInfo<Message>::subscriptionCount.load(std::memory_order_relaxed) == 0)
+        return;
+
+    uint32_t id = MessageTypeInfo<Message>::getId();
+    std::lock_guard<std::recursive_mutex> lock(mSubscribersMutex);
+#endif
+
+    if(id < mSubscribers.size() && mSubscribers[id].mSubscriptions.size() > mSubscribers[id].mRemovedCount)
     {
-        const auto& list = listIterator->second;
-        if(list.size() > 0)
+        mSubscribers[id].mDeliveries++;
+
+        //the list is indexed anew every time since handlers subscribing to new message types may reallocate it. Receivers unsubscribing from within a handler are left in place but skipped
+        size_t count = mSubscribers[id].mSubscriptions.size();
+#if defined(FEA_MESSAGE_STATS)
+        uint32_t fanOut = 0;
+#endif
+
+        for(size_t i = 0; i < count; i++)
         {
-            for(auto subscriber : list)
+            MessageReceiverBase* subscriber = mSubscribers[id].mSubscriptions[i].mReceiver;
+
+            if(subscriber)
+            {
+#if defined(FEA_MESSAGE_STATS)
+                auto start = std::chrono::high_resolution_clock::now();
+#endif
                 static_cast<MessageReceiverSingle<Message>*>(subscriber)->handleMessage(mess);
+#if defined(FEA_MESSAGE_STATS)
+                recordHandlerCall(id, start);
+                fanOut++;
+#endif
+            }
         }
+
+#if defined(FEA_MESSAGE_STATS)
+        recordFanOut(id, fanOut);
+#endif
+        endDelivery(mSubscribers[id]);
     }
 }
+
+template<class Message>
+void MessageBus::post(const Message& message)
+{
+    uint32_t id = MessageTypeInfo<Message>::getId();
+    PostQueues& queues = getPostQueues();
+    std::lock_guard<std::mutex> lock(queues.mMutex);
+
+    if(id >= queues.mQueues.size())
+        queues.mQueues.resize(id + 1);
+
+    if(!queues.mQueues[id])
+        queues.mQueues[id].reset(new MessageQueue<Message>());
+
+    static_cast<MessageQueue<Message>&>(*queues.mQueues[id]).post(message);
+}
+
+template<class Pool>
+void MessageBus::dispatch(Pool& threadPool)
+{
+    FEA_ASSERT(!isDispatching(), "Cannot dispatch from a handler of a dispatched message!");
+    std::lock_guard<std::mutex> dispatchLock(mDispatchMutex);
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(mSubscribersMutex);
+        collectPosted();
+        gatherThreadSafeDeliveries();
+    }
+
+    //the subscribers lock is not held while the pool delivers, since handlers running on it may send messages or change subscriptions and the lock would be held by the thread waiting for them
+    threadPool.parallelFor(static_cast<uint32_t>(mThreadSafeDeliveries.size()), 1, [this] (uint32_t begin, uint32_t end)
+    {
+        deliverThreadSafe(begin, end);
+    });
+
+    std::lock_guard<std::recursive_mutex> lock(mSubscribersMutex);
+    deliverPosted(true);
+    finishThreadSafeDeliveries();
+}
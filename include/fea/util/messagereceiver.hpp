@@ -1,5 +1,6 @@
 #pragma once
 #include <fea/config.hpp>
+#include <cstdint>
 #include <functional>
 #include <vector>
 
@@ -9,7 +10,7 @@ namespace fea
     template<class... MessageTypes>
     class MessageReceiver;
     template <class... MessageTypes>
-    void subscribe(MessageBus&, MessageReceiver<MessageTypes...>&, bool = true);
+    void subscribe(MessageBus&, MessageReceiver<MessageTypes...>&, bool = true, bool = false, int32_t = 0);
     class FEA_API MessageReceiverBase
     {
     };
@@ -19,6 +20,11 @@ namespace fea
     {
         public:
             virtual void handleMessage(const MessageType& message) = 0;
+            virtual void handleMessages(const std::vector<MessageType>& messages)
+            {
+                for(const auto& message : messages)
+                    handleMessage(message);
+            }
     };
 
     template<class... MessageTypes>
@@ -33,7 +39,7 @@ namespace fea
         private:
             std::vector<std::function<void()>> mDesubscribers;
         template <class... Types>
-        friend void subscribe(MessageBus& bus, MessageReceiver<Types...>&, bool);
+        friend void subscribe(MessageBus& bus, MessageReceiver<Types...>&, bool, bool, int32_t);
     };
     /** @addtogroup Util
      *@{
@@ -65,5 +71,18 @@ namespace fea
      *  }
      *  @endcode
      *  @param message Message to handle.
+     ***
+     *  @fn virtual void MessageReceiver::handleMessages(const std::vector<MessageType>& messages)
+     *  @brief Receive and process a batch of messages queued using MessageBus::post.
+     *
+     *  MessageBus::dispatch hands every subscriber all queued messages of a type in one call. By default, this calls MessageReceiver::handleMessage for each of them. Override it to process the whole batch in one tight loop instead.
+     *  @code
+     *  void Health::handleMessages(const std::vector<DamageMessage>& messages)
+     *  {
+     *      for(const DamageMessage& damage : messages)
+     *          mHealth[damage.target] -= damage.amount;
+     *  }
+     *  @endcode
+     *  @param messages Messages to handle, in the order they were posted.
      ***/
 }
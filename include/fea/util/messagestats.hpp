@@ -0,0 +1,48 @@
+#pragma once
+#include <fea/config.hpp>
+#include <cstdint>
+#include <string>
+
+namespace fea
+{
+    struct FEA_API MessageTypeStats
+    {
+        std::string mName;
+        uint32_t mSendCount;
+        uint32_t mPostCount;
+        uint32_t mHandlerCallCount;
+        uint32_t mMaxFanOut;
+        uint64_t mHandlerNanoseconds;
+        uint64_t mMaxHandlerNanoseconds;
+    };
+
+    /** @addtogroup Util
+     *@{
+     *  @class MessageTypeStats
+     *@}
+     ***
+     *  @class MessageTypeStats
+     *  @brief Traffic of one message type through a MessageBus since its statistics were last reset, filled in by MessageBus::getStats.
+     ***
+     *  @var MessageTypeStats::mName
+     *  @brief Demangled name of the message type.
+     ***
+     *  @var MessageTypeStats::mSendCount
+     *  @brief Amount of messages sent using MessageBus::send, including the ones nothing subscribes to.
+     ***
+     *  @var MessageTypeStats::mPostCount
+     *  @brief Amount of posted messages delivered by MessageBus::dispatch, including the ones discarded for lack of subscribers.
+     ***
+     *  @var MessageTypeStats::mHandlerCallCount
+     *  @brief Amount of calls to MessageReceiver::handleMessage for sent messages and to MessageReceiver::handleMessages for dispatched batches.
+     ***
+     *  @var MessageTypeStats::mMaxFanOut
+     *  @brief Highest amount of subscribers a single sent message or dispatched batch was handed to.
+     ***
+     *  @var MessageTypeStats::mHandlerNanoseconds
+     *  @brief Time spent in handlers in total, in nanoseconds. This includes messages sent or posted by the handlers and delivered right away, which are also counted for their own types.
+     ***
+     *  @var MessageTypeStats::mMaxHandlerNanoseconds
+     *  @brief Time spent in the slowest single handler call, in nanoseconds.
+     ***/
+}
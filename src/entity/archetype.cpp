@@ -0,0 +1,202 @@
+#include <fea/entity/archetype.hpp>
+#include <fea/assert.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <string>
+
+namespace fea
+{
+    const uint32_t Archetype::ChunkSize;
+
+    Archetype::Archetype(const std::vector<uint32_t>& attributes, const std::vector<AttributeType>& types, ChunkPool& pool) :
+        mAttributes(attributes),
+        mChunkCapacity(0),
+        mChunkBytes(0),
+        mPool(&pool)
+    {
+        uint32_t rowSize = 0;
+
+        for(uint32_t attribute : mAttributes)
+        {
+            const AttributeType& type = types[attribute];
+            FEA_ASSERT(type.mAlignment <= alignof(std::max_align_t), "Attributes with an alignment of " + std::to_string(type.mAlignment) + " bytes can not be stored in archetype chunks!");
+
+            if(attribute >= mColumnIndices.size())
+                mColumnIndices.resize(attribute + 1, -1);
+
+            mColumnIndices[attribute] = static_cast<int32_t>(mTypes.size());
+            mTypes.push_back(type);
+            rowSize += type.mSize;
+        }
+
+        if(mTypes.empty())
+            return;
+
+        //shrink the capacity until the columns including their alignment padding fit in a chunk
+        mChunkCapacity = std::max(1u, ChunkSize / rowSize);
+        while(true)
+        {
+            uint32_t bytes = 0;
+            mOffsets.clear();
+
+            for(const auto& type : mTypes)
+            {
+                bytes = (bytes + type.mAlignment - 1) / type.mAlignment * type.mAlignment;
+                mOffsets.push_back(bytes);
+                bytes += type.mSize * mChunkCapacity;
+            }
+
+            if(bytes <= ChunkSize || mChunkCapacity == 1)
+            {
+                mChunkBytes = std::max(bytes, ChunkSize);
+                break;
+            }
+
+            mChunkCapacity--;
+        }
+    }
+
+    Archetype::~Archetype()
+    {
+        clear();
+    }
+
+    const std::vector<uint32_t>& Archetype::getAttributes() const
+    {
+        return mAttributes;
+    }
+
+    bool Archetype::hasAttribute(uint32_t attribute) const
+    {
+        return attribute < mColumnIndices.size() && mColumnIndices[attribute] != -1;
+    }
+
+    bool Archetype::has(uint32_t id) const
+    {
+        return mIds.has(id);
+    }
+
+    uint32_t Archetype::add(uint32_t id)
+    {
+        uint32_t row = mIds.insert(id);
+
+        if(!mTypes.empty())
+        {
+            if(row / mChunkCapacity >= mChunks.size())
+                allocateChunk();
+
+            for(uint32_t column = 0; column < mTypes.size(); column++)
+                mTypes[column].mConstruct(getRow(row, column));
+        }
+
+        return row;
+    }
+
+    void Archetype::remove(uint32_t id)
+    {
+        uint32_t last = mIds.size() - 1;
+        uint32_t row = mIds.erase(id);
+
+        for(uint32_t column = 0; column < mTypes.size(); column++)
+        {
+            const AttributeType& type = mTypes[column];
+            unsigned char* target = getRow(row, column);
+            type.mDestroy(target);
+
+            if(row != last)
+            {
+                unsigned char* source = getRow(last, column);
+                type.mMove(target, source);
+                type.mDestroy(source);
+            }
+        }
+
+        //keep one empty chunk around to not reallocate when adding and removing around a chunk border
+        while(mChunks.size() > 1 && mIds.size() <= (mChunks.size() - 2) * mChunkCapacity)
+            releaseChunk();
+    }
+
+    void Archetype::reserve(uint32_t amount)
+    {
+        mIds.reserve(amount);
+
+        if(!mTypes.empty())
+        {
+            while(mChunks.size() * mChunkCapacity < amount)
+                allocateChunk();
+        }
+    }
+
+    void* Archetype::getValue(uint32_t id, uint32_t attribute)
+    {
+        FEA_ASSERT(hasAttribute(attribute), "Trying to get the value of attribute index " + std::to_string(attribute) + " from an archetype which does not have that attribute!");
+        return getRow(mIds.getIndex(id), static_cast<uint32_t>(mColumnIndices[attribute]));
+    }
+
+    const void* Archetype::getValue(uint32_t id, uint32_t attribute) const
+    {
+        return const_cast<Archetype*>(this)->getValue(id, attribute);
+    }
+
+    uint32_t Archetype::size() const
+    {
+        return mIds.size();
+    }
+
+    const std::vector<uint32_t>& Archetype::getIds() const
+    {
+        return mIds.getIds();
+    }
+
+    uint64_t Archetype::getReservedIdBytes() const
+    {
+        return mIds.getReservedBytes();
+    }
+
+    uint32_t Archetype::getChunkCapacity() const
+    {
+        return mChunkCapacity;
+    }
+
+    uint32_t Archetype::getChunkCount() const
+    {
+        return static_cast<uint32_t>(mChunks.size());
+    }
+
+    void* Archetype::getChunkData(uint32_t chunk, uint32_t attribute)
+    {
+        FEA_ASSERT(hasAttribute(attribute), "Trying to get the values of attribute index " + std::to_string(attribute) + " from an archetype which does not have that attribute!");
+        FEA_ASSERT(chunk < mChunks.size(), "Trying to access chunk " + std::to_string(chunk) + " but there are only " + std::to_string(mChunks.size()) + " chunks!");
+        return mChunks[chunk] + mOffsets[mColumnIndices[attribute]];
+    }
+
+    void Archetype::clear()
+    {
+        for(uint32_t row = 0; row < mIds.size(); row++)
+        {
+            for(uint32_t column = 0; column < mTypes.size(); column++)
+                mTypes[column].mDestroy(getRow(row, column));
+        }
+
+        mIds.clear();
+
+        while(!mChunks.empty())
+            releaseChunk();
+    }
+
+    unsigned char* Archetype::getRow(uint32_t row, uint32_t column)
+    {
+        return mChunks[row / mChunkCapacity] + mOffsets[column] + (row % mChunkCapacity) * mTypes[column].mSize;
+    }
+
+    void Archetype::allocateChunk()
+    {
+        mChunks.push_back(mPool->allocate(mChunkBytes));
+    }
+
+    void Archetype::releaseChunk()
+    {
+        mPool->release(mChunks.back(), mChunkBytes);
+        mChunks.pop_back();
+    }
+}
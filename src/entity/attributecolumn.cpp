@@ -0,0 +1,42 @@
+#include <fea/entity/attributecolumn.hpp>
+
+namespace fea
+{
+    AttributeColumnBase::AttributeColumnBase(std::type_index type) : mType(type)
+    {
+    }
+
+    AttributeColumnBase::~AttributeColumnBase()
+    {
+    }
+
+    std::type_index AttributeColumnBase::getType() const
+    {
+        return mType;
+    }
+
+    bool AttributeColumnBase::has(uint32_t id) const
+    {
+        return mIds.has(id);
+    }
+
+    uint32_t AttributeColumnBase::size() const
+    {
+        return mIds.size();
+    }
+
+    uint32_t AttributeColumnBase::getIndex(uint32_t id) const
+    {
+        return mIds.getIndex(id);
+    }
+
+    const std::vector<uint32_t>& AttributeColumnBase::getIds() const
+    {
+        return mIds.getIds();
+    }
+
+    uint64_t AttributeColumnBase::getReservedIdBytes() const
+    {
+        return mIds.getReservedBytes();
+    }
+}
@@ -0,0 +1,35 @@
+#include <fea/entity/attributeindex.hpp>
+
+namespace fea
+{
+    const uint32_t AttributeIndexBase::noAttribute;
+
+    AttributeIndexBase::AttributeIndexBase(uint32_t attribute, std::type_index type, uint32_t secondaryAttribute) :
+        mAttribute(attribute),
+        mSecondaryAttribute(secondaryAttribute),
+        mType(type),
+        mRefreshedFrame(0),
+        mRefreshedMarks(0),
+        mRefreshedSecondaryMarks(0)
+    {
+    }
+
+    AttributeIndexBase::~AttributeIndexBase()
+    {
+    }
+
+    uint32_t AttributeIndexBase::getAttribute() const
+    {
+        return mAttribute;
+    }
+
+    uint32_t AttributeIndexBase::getSecondaryAttribute() const
+    {
+        return mSecondaryAttribute;
+    }
+
+    std::type_index AttributeIndexBase::getType() const
+    {
+        return mType;
+    }
+}
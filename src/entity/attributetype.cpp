@@ -0,0 +1,17 @@
+#include <fea/entity/attributetype.hpp>
+
+namespace fea
+{
+    AttributeType::AttributeType(std::type_index type) :
+        mType(type),
+        mSize(0),
+        mAlignment(1),
+        mTriviallyCopyable(false),
+        mConstruct(nullptr),
+        mDestroy(nullptr),
+        mMove(nullptr),
+        mCopy(nullptr),
+        mAssign(nullptr)
+    {
+    }
+}
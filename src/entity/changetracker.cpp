@@ -0,0 +1,98 @@
+#include <fea/entity/changetracker.hpp>
+#include <fea/assert.hpp>
+#include <string>
+
+namespace fea
+{
+    ChangeTracker::ChangeTracker(const std::vector<uint32_t>& generations) :
+        mGenerations(generations),
+        mFrames(generations.size(), 0),
+        mLastIds(generations.size(), ~EntityId(0)),
+        mMarks(0)
+    {
+    }
+
+    void ChangeTracker::markChanged(EntityId id, uint32_t frame, bool concurrent)
+    {
+        uint32_t index = getEntityIndex(id);
+
+        if(!concurrent)
+            mMarks++;
+
+        if(index >= mFrames.size())
+        {
+            FEA_ASSERT(!concurrent, "Trying to concurrently mark entity ID '" + std::to_string(id) + "' as changed but it was never marked when it was created!");
+            mFrames.resize(index + 1, 0);
+            mLastIds.resize(index + 1, ~EntityId(0));
+        }
+
+        if(mLastIds[index] == id && mFrames[index] == frame)
+            return;
+
+        mFrames[index] = frame;
+        mLastIds[index] = id;
+
+        if(concurrent)
+        {
+            std::lock_guard<std::mutex> lock(mLogMutex);
+            mLog.push_back(Change{frame, id});
+        }
+        else
+        {
+            mLog.push_back(Change{frame, id});
+
+            if(mLog.size() > 2 * mFrames.size() + 64)
+                compact();
+        }
+    }
+
+    bool ChangeTracker::hasChanged(EntityId id, uint32_t sinceFrame) const
+    {
+        uint32_t index = getEntityIndex(id);
+        return index < mFrames.size() && mLastIds[index] == id && mFrames[index] >= sinceFrame && index < mGenerations.size() && mGenerations[index] == getEntityGeneration(id);
+    }
+
+    uint32_t ChangeTracker::getLogSize() const
+    {
+        return static_cast<uint32_t>(mLog.size());
+    }
+
+    uint64_t ChangeTracker::getMarkCount() const
+    {
+        return mMarks;
+    }
+
+    void ChangeTracker::trim()
+    {
+        mMarks++;
+
+        if(mLog.size() > 2 * mFrames.size() + 64)
+            compact();
+    }
+
+    void ChangeTracker::truncate(uint32_t slotCount)
+    {
+        if(slotCount < mFrames.size())
+        {
+            mFrames.resize(slotCount);
+            mLastIds.resize(slotCount);
+        }
+
+        compact();
+    }
+
+    bool ChangeTracker::isLatest(const Change& change) const
+    {
+        uint32_t index = getEntityIndex(change.mId);
+        return index < mLastIds.size() && index < mGenerations.size() && mLastIds[index] == change.mId && mFrames[index] == change.mFrame && mGenerations[index] == getEntityGeneration(change.mId);
+    }
+
+    void ChangeTracker::compact()
+    {
+        //keeps the order, so the log stays sorted by frame
+        mLog.erase(std::remove_if(mLog.begin(), mLog.end(), [this] (const Change& change)
+        {
+            return !isLatest(change);
+        }), mLog.end());
+    }
+}
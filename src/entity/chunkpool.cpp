@@ -0,0 +1,84 @@
+#include <fea/entity/chunkpool.hpp>
+#include <fea/assert.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <string>
+
+namespace fea
+{
+    const uint32_t ChunkPool::SlabSize;
+
+    ChunkPool::ChunkPool() :
+        mUsedCount(0),
+        mFreeCount(0),
+        mReservedBytes(0)
+    {
+    }
+
+    unsigned char* ChunkPool::allocate(uint32_t bytes)
+    {
+        bytes = roundSize(bytes);
+        std::vector<unsigned char*>& freeChunks = mFreeChunks[bytes];
+
+        if(freeChunks.empty())
+        {
+            //carve a whole slab into chunks at once, handing out the first one
+            uint32_t count = std::max(1u, SlabSize / bytes);
+            mSlabs.emplace_back(new unsigned char[static_cast<size_t>(count) * bytes]);
+            mReservedBytes += static_cast<uint64_t>(count) * bytes;
+            unsigned char* slab = mSlabs.back().get();
+
+            for(uint32_t chunk = count - 1; chunk > 0; chunk--)
+                freeChunks.push_back(slab + static_cast<size_t>(chunk) * bytes);
+
+            mFreeCount += count - 1;
+            mUsedCount++;
+            return slab;
+        }
+
+        unsigned char* chunk = freeChunks.back();
+        freeChunks.pop_back();
+        mFreeCount--;
+        mUsedCount++;
+        return chunk;
+    }
+
+    void ChunkPool::release(unsigned char* chunk, uint32_t bytes)
+    {
+        FEA_ASSERT(mUsedCount > 0, "Trying to release a chunk of " + std::to_string(bytes) + " bytes to a pool which has none in use!");
+        mFreeChunks[roundSize(bytes)].push_back(chunk);
+        mFreeCount++;
+        mUsedCount--;
+    }
+
+    void ChunkPool::clear()
+    {
+        FEA_ASSERT(mUsedCount == 0, "Trying to clear a chunk pool while " + std::to_string(mUsedCount) + " chunks are still in use!");
+        mFreeChunks.clear();
+        mSlabs.clear();
+        mFreeCount = 0;
+        mReservedBytes = 0;
+    }
+
+    uint32_t ChunkPool::getUsedCount() const
+    {
+        return mUsedCount;
+    }
+
+    uint32_t ChunkPool::getFreeCount() const
+    {
+        return mFreeCount;
+    }
+
+    uint64_t ChunkPool::getReservedBytes() const
+    {
+        return mReservedBytes;
+    }
+
+    uint32_t ChunkPool::roundSize(uint32_t bytes)
+    {
+        //keeps every chunk carved out of a slab aligned
+        const uint32_t alignment = alignof(std::max_align_t);
+        return (bytes + alignment - 1) / alignment * alignment;
+    }
+}
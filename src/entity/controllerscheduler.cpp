@@ -0,0 +1,129 @@
+#include <fea/entity/controllerscheduler.hpp>
+#include <fea/assert.hpp>
+#include <algorithm>
+
+namespace fea
+{
+    ControllerScheduler::ControllerScheduler(ThreadPool& threadPool) : mThreadPool(threadPool), mGraphDirty(true)
+    {
+    }
+
+    void ControllerScheduler::addController(EntityController& controller)
+    {
+        mNodes.push_back(Node{&controller, true, {}, {}, 0, {}});
+        mGraphDirty = true;
+    }
+
+    void ControllerScheduler::addController(EntityController& controller, const std::set<std::string>& readAttributes, const std::set<std::string>& writeAttributes)
+    {
+        mNodes.push_back(Node{&controller, false, readAttributes, writeAttributes, 0, {}});
+        mGraphDirty = true;
+    }
+
+    void ControllerScheduler::removeController(EntityController& controller)
+    {
+        auto iterator = std::find_if(mNodes.begin(), mNodes.end(), [&] (const Node& node)
+        {
+            return node.mController == &controller;
+        });
+
+        FEA_ASSERT(iterator != mNodes.end(), "Trying to remove a controller which has not been added to the scheduler!");
+        mNodes.erase(iterator);
+        mGraphDirty = true;
+    }
+
+    void ControllerScheduler::entityCreated(EntityPtr entity)
+    {
+        for(auto& node : mNodes)
+            node.mController->entityCreated(entity);
+    }
+
+    void ControllerScheduler::entityRemoved(EntityId entityId)
+    {
+        for(auto& node : mNodes)
+            node.mController->entityRemoved(entityId);
+    }
+
+    void ControllerScheduler::update(float deltaTime)
+    {
+        if(mGraphDirty)
+            buildGraph();
+
+        for(uint32_t i = 0; i < mNodes.size(); i++)
+            mRemaining[i] = mNodes[i].mDependencyCount;
+
+        ThreadPool::TaskGroup group;
+
+        for(uint32_t i = 0; i < mNodes.size(); i++)
+        {
+            if(mNodes[i].mDependencyCount == 0)
+                schedule(i, group, deltaTime);
+        }
+
+        mThreadPool.wait(group);
+    }
+
+    ThreadPool& ControllerScheduler::getThreadPool()
+    {
+        return mThreadPool;
+    }
+
+    bool ControllerScheduler::conflicts(const Node& first, const Node& second)
+    {
+        if(first.mExclusive || second.mExclusive)
+            return true;
+
+        for(const auto& attribute : first.mWrites)
+        {
+            if(second.mWrites.count(attribute) != 0 || second.mReads.count(attribute) != 0)
+                return true;
+        }
+
+        for(const auto& attribute : second.mWrites)
+        {
+            if(first.mReads.count(attribute) != 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    void ControllerScheduler::buildGraph()
+    {
+        for(auto& node : mNodes)
+        {
+            node.mDependencyCount = 0;
+            node.mDependents.clear();
+        }
+
+        //conflicting controllers run in the order they were added
+        for(uint32_t later = 0; later < mNodes.size(); later++)
+        {
+            for(uint32_t earlier = 0; earlier < later; earlier++)
+            {
+                if(conflicts(mNodes[earlier], mNodes[later]))
+                {
+                    mNodes[earlier].mDependents.push_back(later);
+                    mNodes[later].mDependencyCount++;
+                }
+            }
+        }
+
+        mRemaining.reset(new std::atomic<uint32_t>[mNodes.size()]);
+        mGraphDirty = false;
+    }
+
+    void ControllerScheduler::schedule(uint32_t node, ThreadPool::TaskGroup& group, float deltaTime)
+    {
+        mThreadPool.run(group, [this, node, &group, deltaTime] ()
+        {
+            mNodes[node].mController->update(deltaTime);
+
+            for(uint32_t dependent : mNodes[node].mDependents)
+            {
+                if(--mRemaining[dependent] == 0)
+                    schedule(dependent, group, deltaTime);
+            }
+        });
+    }
+}
@@ -0,0 +1,147 @@
+#include <fea/entity/entitycommandbuffer.hpp>
+#include <fea/entity/controllerscheduler.hpp>
+#include <algorithm>
+#include <atomic>
+
+namespace fea
+{
+    namespace
+    {
+        std::atomic<uint64_t> nextInstance(0);
+
+        //the queue of the last buffer this thread recorded into, so that recording does not need to lock
+        thread_local uint64_t cachedInstance = static_cast<uint64_t>(-1);
+        thread_local void* cachedQueue = nullptr;
+    }
+
+    EntityCommandBuffer::EntityCommandBuffer(EntityManager& entityManager) : mEntityManager(entityManager), mInstance(nextInstance++)
+    {
+    }
+
+    void EntityCommandBuffer::createEntity(const std::set<std::string>& attributes, std::function<void(EntityHandle)> initializer)
+    {
+        getQueue().mCommands.push_back(Command{CREATE, 0, attributes, std::move(initializer)});
+    }
+
+    void EntityCommandBuffer::removeEntity(EntityId id)
+    {
+        getQueue().mCommands.push_back(Command{REMOVE, id, {}, nullptr});
+    }
+
+    std::vector<EntityId> EntityCommandBuffer::playback()
+    {
+        return playback(nullptr);
+    }
+
+    std::vector<EntityId> EntityCommandBuffer::playback(ControllerScheduler& scheduler)
+    {
+        return playback(&scheduler);
+    }
+
+    bool EntityCommandBuffer::isEmpty() const
+    {
+        std::lock_guard<std::mutex> lock(mQueuesMutex);
+
+        for(const auto& queue : mQueues)
+        {
+            if(!queue->mCommands.empty())
+                return false;
+        }
+
+        return true;
+    }
+
+    void EntityCommandBuffer::clear()
+    {
+        std::lock_guard<std::mutex> lock(mQueuesMutex);
+
+        for(auto& queue : mQueues)
+            queue->mCommands.clear();
+    }
+
+    EntityCommandBuffer::Queue& EntityCommandBuffer::getQueue()
+    {
+        if(cachedInstance == mInstance)
+            return *static_cast<Queue*>(cachedQueue);
+
+        std::lock_guard<std::mutex> lock(mQueuesMutex);
+        std::thread::id thread = std::this_thread::get_id();
+
+        auto iterator = std::find_if(mQueues.begin(), mQueues.end(), [&] (const std::unique_ptr<Queue>& queue)
+        {
+            return queue->mThread == thread;
+        });
+
+        if(iterator == mQueues.end())
+        {
+            mQueues.emplace_back(new Queue());
+            mQueues.back()->mThread = thread;
+            iterator = mQueues.end() - 1;
+        }
+
+        cachedInstance = mInstance;
+        cachedQueue = iterator->get();
+        return **iterator;
+    }
+
+    std::vector<EntityId> EntityCommandBuffer::playback(ControllerScheduler* scheduler)
+    {
+        std::lock_guard<std::mutex> lock(mQueuesMutex);
+        std::vector<EntityId> created;
+        std::vector<EntityId> removed;
+
+        for(auto& queue : mQueues)
+        {
+            for(auto& command : queue->mCommands)
+            {
+                if(command.mType == CREATE)
+                {
+                    EntityHandle entity = mEntityManager.createHandle(command.mAttributes);
+
+                    if(command.mFunction)
+                        command.mFunction(entity);
+
+                    created.push_back(entity.getId());
+                }
+                else if(command.mType == REMOVE)
+                {
+                    removed.push_back(command.mId);
+                }
+                else if(mEntityManager.isValid(command.mId))
+                {
+                    command.mFunction(mEntityManager.getHandle(command.mId));
+                }
+            }
+
+            queue->mCommands.clear();
+        }
+
+        std::sort(removed.begin(), removed.end());
+        removed.erase(std::unique(removed.begin(), removed.end()), removed.end());
+        removed.erase(std::remove_if(removed.begin(), removed.end(), [&] (EntityId id)
+        {
+            return !mEntityManager.isValid(id);
+        }), removed.end());
+
+        if(scheduler)
+        {
+            for(EntityId id : created)
+            {
+                if(!std::binary_search(removed.begin(), removed.end(), id))
+                    scheduler->entityCreated(mEntityManager.findEntity(id).lock());
+            }
+
+            for(EntityId id : removed)
+                scheduler->entityRemoved(id);
+        }
+
+        mEntityManager.removeEntities(removed);
+
+        created.erase(std::remove_if(created.begin(), created.end(), [&] (EntityId id)
+        {
+            return !mEntityManager.isValid(id);
+        }), created.end());
+
+        return created;
+    }
+}
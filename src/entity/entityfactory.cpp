@@ -1,12 +1,23 @@
 #include <fea/entity/entityfactory.hpp>
 #include <fea/entity/entity.hpp>
 #include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
 
 namespace fea
 {
-    bool EntityFactory::Prototype::Value::operator<(const Value& other) const
+    const uint32_t templateCacheMagic = 0x54414546;
+    const uint32_t templateCacheVersion = 1;
+
+    EntityFactory::Prototype::Prototype() : mCopyOnWrite(false)
+    {
+    }
+
+    EntityFactory::Prototype::~Prototype()
     {
-        return mKey < other.mKey;
+        for(const auto& value : mDefaults)
+            value.mType.mDestroy(mImage.get() + value.mOffset);
     }
 
     EntityFactory::EntityFactory(EntityManager& entityManager) : mManager(entityManager)
@@ -25,22 +36,29 @@ namespace fea
     {
         FEA_ASSERT(mPrototypes.find(name) == mPrototypes.end(), "Trying to add entity template '" + name + "' but there exists already such a template!");
 
-        Prototype prototype;
+        const EntityStorage& storage = mManager.mStorage;
+
+        //where every attribute and default value comes from, indexed by attribute. Later parents override earlier ones and the template itself overrides its parents
+        struct Source
+        {
+            bool mPresent;
+            const unsigned char* mInherited;
+            const std::string* mArguments;
+            const Parser* mParser;
+        };
+
+        std::vector<Source> sources(storage.getAttributeCount(), Source{false, nullptr, nullptr, nullptr});
 
         for(const auto& parentTemplate : entityTemplate.mInherits)
         {
             FEA_ASSERT(mPrototypes.find(parentTemplate) != mPrototypes.end(), "Trying to let entity template '" +name + "' inherit template called '" + parentTemplate + "' which has not been added!");
-            auto& parent = mPrototypes.at(parentTemplate);
-            
-            std::set<std::string> result;
-            std::set_union(parent.attributes.begin(), parent.attributes.end(), prototype.attributes.begin(), prototype.attributes.end(), std::inserter(result, result.begin()));
-
-            prototype.attributes = result;
+            const Prototype& parent = *mPrototypes.at(parentTemplate);
 
-            std::set<Prototype::Value> result2;
-            std::set_union(parent.values.begin(), parent.values.end(), prototype.values.begin(), prototype.values.end(), std::inserter(result2, result2.begin()));
+            for(uint32_t attribute : parent.mAttributes)
+                sources[attribute].mPresent = true;
 
-            prototype.values = result2;
+            for(const auto& value : parent.mDefaults)
+                sources[value.mAttribute] = Source{true, parent.mImage.get() + value.mOffset, nullptr, nullptr};
         }
 
         for(const auto& element : entityTemplate.mAttributes)
@@ -50,25 +68,56 @@ namespace fea
 
             FEA_ASSERT(mParsers.find(attribute) != mParsers.end(), "Trying to add a template with the attribute '" + attribute + "' which doesn't exist!");
 
-            if(prototype.attributes.find(attribute) == prototype.attributes.end())
-            {
-                prototype.attributes.insert(attribute);
-                if(arguments.size() > 0)
-                {
-                    prototype.values.insert({attribute, mParsers.at(attribute)(arguments)}); 
-                }
-            }
+            if(arguments.size() > 0)
+                sources[storage.getAttributeIndex(attribute)] = Source{true, nullptr, &arguments, &mParsers.at(attribute)};
             else
+                sources[storage.getAttributeIndex(attribute)] = Source{true, nullptr, nullptr, nullptr};
+        }
+
+        std::shared_ptr<Prototype> created = std::make_shared<Prototype>();
+        Prototype& prototype = *created;
+        std::vector<Prototype::DefaultValue> layout;
+        uint32_t imageSize = 0;
+
+        for(uint32_t attribute = 0; attribute < sources.size(); attribute++)
+        {
+            const Source& source = sources[attribute];
+
+            if(!source.mPresent)
+                continue;
+
+            prototype.mAttributes.push_back(attribute);
+
+            if(source.mInherited || source.mArguments)
             {
-                prototype.values.erase({attribute});
-                if(arguments.size() > 0)
-                {
-                    prototype.values.insert({attribute, mParsers.at(attribute)(arguments)}); 
-                }
+                const AttributeType& type = storage.getAttributeType(attribute);
+                FEA_ASSERT(type.mAssign != nullptr, "Trying to give a default value to attribute '" + mManager.mStorage.mAttributeNames[attribute] + "' in template '" + name + "' but its type is not copyable!");
+                FEA_ASSERT(type.mAlignment <= alignof(std::max_align_t), "Attributes with an alignment of " + std::to_string(type.mAlignment) + " bytes can not have default values!");
+
+                imageSize = (imageSize + type.mAlignment - 1) / type.mAlignment * type.mAlignment;
+                layout.push_back(Prototype::DefaultValue{attribute, imageSize, type});
+                imageSize += type.mSize;
             }
         }
 
-        mPrototypes.emplace(name, std::move(prototype));
+        if(imageSize > 0)
+            prototype.mImage.reset(new unsigned char[imageSize]);
+
+        //values are only added to the prototype once constructed, so that a throwing parser leaves nothing to destroy
+        for(const auto& value : layout)
+        {
+            const Source& source = sources[value.mAttribute];
+            unsigned char* destination = prototype.mImage.get() + value.mOffset;
+
+            if(source.mInherited)
+                value.mType.mCopy(destination, source.mInherited);
+            else
+                (*source.mParser)(*source.mArguments, destination);
+
+            prototype.mDefaults.push_back(value);
+        }
+
+        mPrototypes.emplace(name, std::move(created));
     }
     
     bool EntityFactory::hasTemplate(const std::string& name) const
@@ -76,15 +125,213 @@ namespace fea
         return mPrototypes.find(name) != mPrototypes.end();
     }
 
+    void EntityFactory::setCopyOnWrite(const std::string& name, bool enabled)
+    {
+        FEA_ASSERT(mPrototypes.find(name) != mPrototypes.end(), "Trying to set copy-on-write for entity template '" + name + "' but such a template does not exist!");
+        mPrototypes.at(name)->mCopyOnWrite = enabled;
+    }
+
     WeakEntityPtr EntityFactory::instantiate(const std::string& name)
     {
         FEA_ASSERT(mPrototypes.find(name) != mPrototypes.end(), "Trying to instantiate entity template '" + name + "' but such a template does not exist!");
-        const Prototype& entityPrototype = mPrototypes.at(name);
-        EntityPtr entity = mManager.createEntity(entityPrototype.attributes).lock();
-        for(const auto& value : entityPrototype.values)
-            value.mSetter(entity);
+        const std::shared_ptr<Prototype>& entityPrototype = mPrototypes.at(name);
+        std::vector<EntityId> ids(1, mManager.mStorage.addEntity(entityPrototype->mAttributes));
+        mManager.trackEntities(ids);
+        applyDefaults(entityPrototype, ids);
+
+        return mManager.findEntity(ids[0]);
+    }
+
+    std::vector<EntityHandle> EntityFactory::instantiate(const std::string& name, uint32_t count)
+    {
+        FEA_ASSERT(mPrototypes.find(name) != mPrototypes.end(), "Trying to instantiate entity template '" + name + "' but such a template does not exist!");
+        const std::shared_ptr<Prototype>& entityPrototype = mPrototypes.at(name);
+        std::vector<EntityId> ids = mManager.mStorage.addEntities(entityPrototype->mAttributes, count);
+        applyDefaults(entityPrototype, ids);
+
+        return mManager.trackEntities(ids);
+    }
+
+    std::vector<EntityHandle> EntityFactory::instantiate(const std::string& name, uint32_t count, const std::function<void(EntityHandle, uint32_t)>& initializer)
+    {
+        std::vector<EntityHandle> entities = instantiate(name, count);
+
+        for(uint32_t i = 0; i < count; i++)
+            initializer(entities[i], i);
+
+        return entities;
+    }
+
+    bool EntityFactory::saveTemplateCache(const std::vector<std::string>& templates, uint64_t sourceHash, std::vector<uint8_t>& data) const
+    {
+        const EntityStorage& storage = mManager.mStorage;
+        data.clear();
+        SnapshotWriter writer(data);
+
+        writer.write(templateCacheMagic);
+        writer.write(templateCacheVersion);
+        writer.write(sourceHash);
+        //the total size is filled in at the end so that truncated caches can be detected
+        writer.write(uint64_t(0));
+        writer.write(static_cast<uint32_t>(templates.size()));
+
+        for(const auto& name : templates)
+        {
+            FEA_ASSERT(mPrototypes.find(name) != mPrototypes.end(), "Trying to cache entity template '" + name + "' but such a template does not exist!");
+            const Prototype& prototype = *mPrototypes.at(name);
+
+            writer.write(name);
+            writer.write(static_cast<uint32_t>(prototype.mAttributes.size()));
+
+            for(uint32_t attribute : prototype.mAttributes)
+                writer.write(storage.mAttributeNames[attribute]);
+
+            //the types of all values come before the values, so that the image can be laid out before reading values of varying size
+            writer.write(static_cast<uint32_t>(prototype.mDefaults.size()));
+
+            for(const auto& value : prototype.mDefaults)
+            {
+                writer.write(storage.mAttributeNames[value.mAttribute]);
+                writer.write(std::string(value.mType.mType.name()));
+                writer.write(value.mType.mSize);
+            }
+
+            for(const auto& value : prototype.mDefaults)
+            {
+                const unsigned char* source = prototype.mImage.get() + value.mOffset;
 
-        return entity;
+                if(value.mType.mTriviallyCopyable)
+                {
+                    writer.write(source, value.mType.mSize);
+                }
+                else
+                {
+                    auto serializer = storage.mSerializers.find(value.mType.mType);
+
+                    if(serializer == storage.mSerializers.end())
+                    {
+                        data.clear();
+                        return false;
+                    }
+
+                    serializer->second.mWrite(source, writer);
+                }
+            }
+        }
+
+        uint64_t size = data.size();
+        std::memcpy(data.data() + 2 * sizeof(uint32_t) + sizeof(uint64_t), &size, sizeof(size));
+        return true;
+    }
+
+    bool EntityFactory::loadTemplateCache(const std::vector<uint8_t>& data, uint64_t sourceHash)
+    {
+        const EntityStorage& storage = mManager.mStorage;
+
+        if(data.size() < 3 * sizeof(uint32_t) + 2 * sizeof(uint64_t))
+            return false;
+
+        SnapshotReader reader(data.data(), data.size());
+
+        if(reader.read<uint32_t>() != templateCacheMagic || reader.read<uint32_t>() != templateCacheVersion || reader.read<uint64_t>() != sourceHash || reader.read<uint64_t>() != data.size())
+            return false;
+
+        uint32_t templateCount = reader.read<uint32_t>();
+
+        //all templates are read before any is added, so that an incompatible cache adds nothing
+        std::vector<std::pair<std::string, std::shared_ptr<Prototype>>> prototypes;
+        prototypes.reserve(templateCount);
+
+        for(uint32_t i = 0; i < templateCount; i++)
+        {
+            prototypes.emplace_back(reader.readString(), std::make_shared<Prototype>());
+            Prototype& prototype = *prototypes.back().second;
+            FEA_ASSERT(mPrototypes.find(prototypes.back().first) == mPrototypes.end(), "Trying to load entity template '" + prototypes.back().first + "' from a cache but there exists already such a template!");
+
+            uint32_t attributeCount = reader.read<uint32_t>();
+
+            for(uint32_t a = 0; a < attributeCount; a++)
+            {
+                std::string attribute = reader.readString();
+
+                if(!storage.attributeIsValid(attribute))
+                    return false;
+
+                prototype.mAttributes.push_back(storage.getAttributeIndex(attribute));
+            }
+
+            //attribute indices depend on the registration order, which may differ from when the cache was written
+            std::sort(prototype.mAttributes.begin(), prototype.mAttributes.end());
+
+            uint32_t defaultCount = reader.read<uint32_t>();
+            std::vector<Prototype::DefaultValue> layout;
+            uint32_t imageSize = 0;
+
+            for(uint32_t d = 0; d < defaultCount; d++)
+            {
+                std::string attribute = reader.readString();
+                std::string typeName = reader.readString();
+                uint32_t size = reader.read<uint32_t>();
+
+                if(!storage.attributeIsValid(attribute))
+                    return false;
+
+                uint32_t index = storage.getAttributeIndex(attribute);
+                const AttributeType& type = storage.getAttributeType(index);
+
+                if(typeName != type.mType.name() || size != type.mSize || (!type.mTriviallyCopyable && storage.mSerializers.find(type.mType) == storage.mSerializers.end()))
+                    return false;
+
+                imageSize = (imageSize + type.mAlignment - 1) / type.mAlignment * type.mAlignment;
+                layout.push_back(Prototype::DefaultValue{index, imageSize, type});
+                imageSize += type.mSize;
+            }
+
+            if(imageSize > 0)
+                prototype.mImage.reset(new unsigned char[imageSize]);
+
+            for(const auto& value : layout)
+            {
+                unsigned char* destination = prototype.mImage.get() + value.mOffset;
+
+                //constructed before reading so that the prototype destroys it like any other value
+                value.mType.mConstruct(destination);
+                prototype.mDefaults.push_back(value);
+
+                if(value.mType.mTriviallyCopyable)
+                    reader.read(destination, value.mType.mSize);
+                else
+                    storage.mSerializers.at(value.mType.mType).mRead(destination, reader);
+            }
+        }
+
+        for(auto& prototype : prototypes)
+            mPrototypes.emplace(prototype.first, std::move(prototype.second));
+
+        return true;
+    }
+
+    void EntityFactory::applyDefaults(const std::shared_ptr<Prototype>& prototype, const std::vector<EntityId>& ids)
+    {
+        EntityStorage& storage = mManager.mStorage;
+
+        if(prototype->mCopyOnWrite && !prototype->mDefaults.empty())
+            storage.retainSharedValues(prototype);
+
+        for(const auto& value : prototype->mDefaults)
+        {
+            const unsigned char* source = prototype->mImage.get() + value.mOffset;
+
+            if(prototype->mCopyOnWrite)
+            {
+                storage.shareValues(ids, value.mAttribute, source);
+            }
+            else
+            {
+                for(EntityId id : ids)
+                    value.mType.mAssign(storage.getValue(getEntityIndex(id), value.mAttribute), source);
+            }
+        }
     }
 
     Parameters EntityFactory::splitByDelimeter(const std::string& in, char delimeter) const
@@ -0,0 +1,49 @@
+#include <fea/entity/entityhandle.hpp>
+
+namespace fea
+{
+    static_assert(std::is_trivially_copyable<EntityHandle>::value, "EntityHandle must stay trivially copyable");
+
+    EntityHandle::EntityHandle() : mId(0), mEntityManager(nullptr)
+    {
+    }
+
+    EntityHandle::EntityHandle(EntityId id, EntityManager& entityManager) : mId(id), mEntityManager(&entityManager)
+    {
+    }
+
+    bool EntityHandle::hasAttribute(const std::string& attribute) const
+    {
+        return mEntityManager->hasAttribute(mId, attribute);
+    }
+
+    EntityId EntityHandle::getId() const
+    {
+        return mId;
+    }
+
+    EntityManager* EntityHandle::getEntityManager() const
+    {
+        return mEntityManager;
+    }
+
+    bool EntityHandle::isValid() const
+    {
+        return mEntityManager != nullptr && mEntityManager->isValid(mId);
+    }
+
+    std::unordered_set<std::string> EntityHandle::getAttributes() const
+    {
+        return mEntityManager->getAttributes(mId);
+    }
+
+    bool EntityHandle::operator==(const EntityHandle& other) const
+    {
+        return mId == other.mId && mEntityManager == other.mEntityManager;
+    }
+
+    bool EntityHandle::operator!=(const EntityHandle& other) const
+    {
+        return !(*this == other);
+    }
+}
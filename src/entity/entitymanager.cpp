@@ -4,39 +4,86 @@
 
 namespace fea
 {
+    EntityManager::EntityManager(EntityStorage::StorageLayout layout) : mStorage(layout)
+    {
+    }
+
     WeakEntityPtr EntityManager::createEntity(const std::set<std::string>& attributes)
     {
-        EntityId createdId = mStorage.addEntity(attributes);
-        EntityPtr created = std::make_shared<Entity>(createdId, *this);
-        mEntities.insert(std::pair<EntityId, EntityPtr>(createdId, created));
-        return WeakEntityPtr(created);
+        return findEntity(createHandle(attributes).getId());
     }
 
-    WeakEntityPtr EntityManager::findEntity(EntityId id) const
+    EntityHandle EntityManager::createHandle(const std::set<std::string>& attributes)
     {
-        auto iterator = mEntities.find(id);
+        trackEntity(mStorage.addEntity(attributes));
+        return mHandles.back();
+    }
+
+    std::vector<EntityHandle> EntityManager::createHandles(const std::set<std::string>& attributes, uint32_t count)
+    {
+        return trackEntities(mStorage.addEntities(attributes, count));
+    }
+
+    std::vector<EntityHandle> EntityManager::clone(EntityId id, uint32_t count)
+    {
+        FEA_ASSERT(isValid(id), "Trying to clone entity ID '" + std::to_string(id) + "' but it doesn't exist!");
+        return trackEntities(mStorage.cloneEntity(getEntityIndex(id), count));
+    }
 
-        if(iterator != mEntities.end())
+    WeakEntityPtr EntityManager::findEntity(EntityId id) const
+    {
+        if(isValid(id))
         {
-            return iterator->second;
+            //the Entity is created lazily, and atomically so that concurrent lookups of the same entity get the same instance
+            EntityPtr* slot = &mEntities[getEntityIndex(id)];
+            EntityPtr entity = std::atomic_load(slot);
+
+            if(!entity)
+            {
+                EntityPtr created = std::make_shared<Entity>(id, const_cast<EntityManager&>(*this));
+
+                if(std::atomic_compare_exchange_strong(slot, &entity, created))
+                    entity = created;
+            }
+
+            return entity;
         }
         else    
         {
             return WeakEntityPtr();
         }
     }
+
+    EntityHandle EntityManager::getHandle(EntityId id)
+    {
+        FEA_ASSERT(isValid(id), "Trying to get a handle to entity ID '" + std::to_string(id) + "' but it doesn't exist!");
+        return mHandles[mHandleIndices[getEntityIndex(id)]];
+    }
     
     void EntityManager::removeEntity(const EntityId id)
     {
-        FEA_ASSERT(mEntities.find(id) != mEntities.end(), "Trying to delete entity ID '" + std::to_string(id) + "' but it doesn't exist!");
+        FEA_ASSERT(isValid(id), "Trying to delete entity ID '" + std::to_string(id) + "' but it doesn't exist!");
         mStorage.removeEntity(id);
-        mEntities.erase(id);
+        releaseEntity(id);
+    }
+
+    void EntityManager::removeEntities(const std::vector<EntityId>& ids)
+    {
+        mStorage.removeEntities(ids);
+
+        for(EntityId id : ids)
+            releaseEntity(id);
+    }
+
+    bool EntityManager::isValid(const EntityId id) const
+    {
+        return mStorage.isValid(id);
     }
     
     bool EntityManager::hasAttribute(const EntityId id, const std::string& attribute) const
     {
-        FEA_ASSERT(mEntities.find(id) != mEntities.end(), "Trying to check if entity ID '" + std::to_string(id) + "' has attribute '" + attribute + "' but that entity doesn't exist!");
-        return mStorage.hasData(id, attribute);
+        FEA_ASSERT(isValid(id), "Trying to check if entity ID '" + std::to_string(id) + "' has attribute '" + attribute + "' but that entity doesn't exist!");
+        return mStorage.hasData(getEntityIndex(id), attribute);
     }
     
     bool EntityManager::attributeIsValid(const std::string& attributeName) const
@@ -44,29 +91,149 @@ namespace fea
         return mStorage.attributeIsValid(attributeName);
     }
 
+    void EntityManager::sortColumns(const EntityQueryBase& query)
+    {
+        mStorage.sortColumns(query);
+    }
+
     EntitySet EntityManager::getAll() const
     {
         EntitySet all;
-        for(const auto& pair : mEntities)
-            all.insert(pair.second);
+        for(const auto& handle : mHandles)
+            all.insert(findEntity(handle.getId()));
         return all;
     }
 
+    const std::vector<EntityHandle>& EntityManager::getHandles() const
+    {
+        return mHandles;
+    }
+
     void EntityManager::removeAll()
     {
-        while(mEntities.size() > 0)
-            removeEntity(mEntities.begin()->first);
+        while(mHandles.size() > 0)
+            removeEntity(mHandles.back().getId());
     }
 
     void EntityManager::clear()
     {
         mEntities.clear();
+        mHandles.clear();
+        mHandleIndices.clear();
         mStorage.clear();
     }
     
     std::unordered_set<std::string> EntityManager::getAttributes(EntityId id) const
     {
-        FEA_ASSERT(mEntities.find(id) != mEntities.end(), "Trying to get the attributes of entity entity ID '" + std::to_string(id) + "' but such an entity doesn't exist!");
-        return mStorage.getAttributes(id);
+        FEA_ASSERT(isValid(id), "Trying to get the attributes of entity entity ID '" + std::to_string(id) + "' but such an entity doesn't exist!");
+        return mStorage.getAttributes(getEntityIndex(id));
+    }
+
+    void EntityManager::beginConcurrentAccess()
+    {
+        mStorage.beginConcurrentAccess();
+    }
+
+    void EntityManager::endConcurrentAccess()
+    {
+        mStorage.endConcurrentAccess();
+    }
+
+    bool EntityManager::isConcurrentAccess() const
+    {
+        return mStorage.isConcurrentAccess();
+    }
+
+    void EntityManager::trackChanges(const std::string& attribute)
+    {
+        mStorage.trackChanges(mStorage.getAttributeIndex(attribute));
+    }
+
+    void EntityManager::markChanged(EntityId id, const std::string& attribute)
+    {
+        FEA_ASSERT(isValid(id), "Trying to mark attribute '" + attribute + "' of entity ID '" + std::to_string(id) + "' as changed but that entity doesn't exist!");
+        mStorage.markChanged(getEntityIndex(id), mStorage.getAttributeIndex(attribute));
+    }
+
+    bool EntityManager::hasChanged(EntityId id, const std::string& attribute, uint32_t sinceFrame) const
+    {
+        return mStorage.getChangeTracker(mStorage.getAttributeIndex(attribute)).hasChanged(id, sinceFrame);
+    }
+
+    uint32_t EntityManager::getFrame() const
+    {
+        return mStorage.getFrame();
+    }
+
+    void EntityManager::nextFrame()
+    {
+        mStorage.nextFrame();
+    }
+
+    void EntityManager::saveSnapshot(std::vector<uint8_t>& data) const
+    {
+        data.clear();
+        SnapshotWriter writer(data);
+        mStorage.writeSnapshot(writer);
+    }
+
+    bool EntityManager::loadSnapshot(const std::vector<uint8_t>& data)
+    {
+        SnapshotReader reader(data.data(), data.size());
+        std::vector<EntityId> ids;
+
+        if(!mStorage.readSnapshot(reader, ids))
+            return false;
+
+        mEntities.clear();
+        mHandles.clear();
+        mHandleIndices.clear();
+        mHandles.reserve(ids.size());
+
+        for(EntityId id : ids)
+            trackEntity(id);
+
+        return true;
+    }
+
+    void EntityManager::getStats(EntityStats& stats) const
+    {
+        mStorage.getStats(stats);
+        stats.mReservedHandleBytes = mHandles.capacity() * sizeof(EntityHandle) + mHandleIndices.capacity() * sizeof(uint32_t) + mEntities.capacity() * sizeof(EntityPtr);
+    }
+
+    std::vector<EntityHandle> EntityManager::trackEntities(const std::vector<EntityId>& ids)
+    {
+        mHandles.reserve(mHandles.size() + ids.size());
+
+        for(EntityId id : ids)
+            trackEntity(id);
+
+        return std::vector<EntityHandle>(mHandles.end() - ids.size(), mHandles.end());
+    }
+
+    void EntityManager::trackEntity(EntityId id)
+    {
+        uint32_t index = getEntityIndex(id);
+
+        if(index >= mEntities.size())
+        {
+            mEntities.resize(index + 1);
+            mHandleIndices.resize(index + 1);
+        }
+
+        mHandleIndices[index] = static_cast<uint32_t>(mHandles.size());
+        mHandles.emplace_back(id, *this);
+    }
+
+    void EntityManager::releaseEntity(EntityId id)
+    {
+        uint32_t index = getEntityIndex(id);
+        mEntities[index].reset();
+
+        uint32_t handleIndex = mHandleIndices[index];
+        mHandles[handleIndex] = mHandles.back();
+        mHandleIndices[getEntityIndex(mHandles[handleIndex].getId())] = handleIndex;
+        mHandles.pop_back();
     }
 }
@@ -0,0 +1,117 @@
+#include <fea/entity/entityquery.hpp>
+#include <algorithm>
+
+namespace fea
+{
+    EntityQueryBase::EntityQueryBase(const std::vector<uint32_t>& attributes, const std::vector<AttributeColumnBase*>& columns, const std::vector<uint32_t>& generations) : mAttributes(attributes), mColumns(columns), mGenerations(generations)
+    {
+        if(mColumns.empty())
+            return;
+
+        AttributeColumnBase* smallest = mColumns[0];
+
+        for(auto column : mColumns)
+        {
+            if(column->size() < smallest->size())
+                smallest = column;
+        }
+
+        for(uint32_t id : smallest->getIds())
+        {
+            if(matches(id))
+                mMatches.insert(id);
+        }
+    }
+
+    EntityQueryBase::~EntityQueryBase()
+    {
+    }
+
+    bool EntityQueryBase::has(EntityId id) const
+    {
+        uint32_t index = getEntityIndex(id);
+
+        if(index >= mGenerations.size() || mGenerations[index] != getEntityGeneration(id))
+            return false;
+
+        if(mColumns.empty())
+        {
+            for(auto archetype : mArchetypes)
+            {
+                if(archetype->has(index))
+                    return true;
+            }
+
+            return false;
+        }
+
+        return mMatches.has(index);
+    }
+
+    uint32_t EntityQueryBase::size() const
+    {
+        if(mColumns.empty())
+        {
+            uint32_t result = 0;
+
+            for(auto archetype : mArchetypes)
+                result += archetype->size();
+
+            return result;
+        }
+
+        return mMatches.size();
+    }
+
+    bool EntityQueryBase::matches(uint32_t id) const
+    {
+        for(auto column : mColumns)
+        {
+            if(!column->has(id))
+                return false;
+        }
+
+        return true;
+    }
+
+    uint32_t EntityQueryBase::getPackedEnd(uint32_t begin, uint32_t end) const
+    {
+        const std::vector<uint32_t>& matches = mMatches.getIds();
+
+        for(auto column : mColumns)
+        {
+            const std::vector<uint32_t>& ids = column->getIds();
+            end = std::min(end, static_cast<uint32_t>(ids.size()));
+
+            if(end <= begin)
+                return begin;
+
+            end = static_cast<uint32_t>(std::mismatch(matches.begin() + begin, matches.begin() + end, ids.begin() + begin).first - matches.begin());
+        }
+
+        return end;
+    }
+
+    void EntityQueryBase::entityCreated(uint32_t id)
+    {
+        if(matches(id))
+            mMatches.insert(id);
+    }
+
+    void EntityQueryBase::entityRemoved(uint32_t id)
+    {
+        if(mMatches.has(id))
+            mMatches.erase(id);
+    }
+
+    void EntityQueryBase::archetypeCreated(Archetype& archetype)
+    {
+        for(uint32_t attribute : mAttributes)
+        {
+            if(!archetype.hasAttribute(attribute))
+                return;
+        }
+
+        mArchetypes.push_back(&archetype);
+    }
+}
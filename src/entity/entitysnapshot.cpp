@@ -0,0 +1,86 @@
+#include <fea/entity/entitysnapshot.hpp>
+
+namespace fea
+{
+    SnapshotWriter::SnapshotWriter(std::vector<uint8_t>& data) : mData(data)
+    {
+    }
+
+    void SnapshotWriter::write(const void* source, uint32_t size)
+    {
+        if(size > 0)
+            std::memcpy(allocate(size), source, size);
+    }
+
+    void SnapshotWriter::write(const std::string& value)
+    {
+        write(static_cast<uint32_t>(value.size()));
+        write(value.data(), static_cast<uint32_t>(value.size()));
+    }
+
+    uint8_t* SnapshotWriter::allocate(uint32_t size)
+    {
+        size_t position = mData.size();
+        mData.resize(position + size);
+        return mData.data() + position;
+    }
+
+    SnapshotReader::SnapshotReader(const uint8_t* data, size_t size) :
+        mData(data),
+        mSize(size),
+        mPosition(0),
+        mFailed(false)
+    {
+    }
+
+    void SnapshotReader::read(void* destination, uint32_t size)
+    {
+        if(size == 0)
+            return;
+
+        if(const uint8_t* source = skip(size))
+            std::memcpy(destination, source, size);
+        else
+            std::memset(destination, 0, size);
+    }
+
+    std::string SnapshotReader::readString()
+    {
+        uint32_t size = read<uint32_t>();
+        const uint8_t* characters = skip(size);
+
+        if(!characters)
+            return std::string();
+
+        return std::string(reinterpret_cast<const char*>(characters), size);
+    }
+
+    const uint8_t* SnapshotReader::skip(uint32_t size)
+    {
+        //snapshots may come from truncated or corrupt files, so running out of data is remembered for the caller to check instead of asserted
+        if(mFailed || mSize - mPosition < size)
+        {
+            mFailed = true;
+            return nullptr;
+        }
+
+        const uint8_t* result = mData + mPosition;
+        mPosition += size;
+        return result;
+    }
+
+    bool SnapshotReader::isAtEnd() const
+    {
+        return mPosition == mSize;
+    }
+
+    size_t SnapshotReader::getRemainingSize() const
+    {
+        return mSize - mPosition;
+    }
+
+    bool SnapshotReader::hasFailed() const
+    {
+        return mFailed;
+    }
+}
@@ -1,67 +1,384 @@
 #include <string>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
 #include <fea/entity/entitystorage.hpp>
 
 namespace fea
 {
-    EntityStorage::StorageEntity::StorageEntity(const std::set<std::string>& attributeList)
+    const uint32_t snapshotMagic = 0x53414546;
+    const uint32_t snapshotVersion = 1;
+
+    namespace
     {
-        for(const auto& attribute : attributeList)
-            attributeData.emplace(attribute, std::shared_ptr<void>());
+        bool readSnapshotIds(SnapshotReader& reader, std::vector<uint32_t>& ids)
+        {
+            uint32_t count = reader.read<uint32_t>();
+
+            //checked before resizing, so that a corrupt count does not allocate more memory than the data could fill
+            if(count > reader.getRemainingSize() / sizeof(uint32_t) || count > std::numeric_limits<uint32_t>::max() / sizeof(uint32_t))
+                return false;
+
+            ids.resize(count);
+            reader.read(ids.data(), static_cast<uint32_t>(count * sizeof(uint32_t)));
+            return !reader.hasFailed();
+        }
+
+        //default constructed values for a serializer to read into, destroyed along with the buffer
+        class SnapshotValues
+        {
+            public:
+                SnapshotValues(const AttributeType& type, uint32_t count) :
+                    mType(type),
+                    mCount(count),
+                    mValues(new unsigned char[static_cast<size_t>(count) * type.mSize])
+                {
+                    for(uint32_t i = 0; i < mCount; i++)
+                        mType.mConstruct(get(i));
+                }
+
+                ~SnapshotValues()
+                {
+                    for(uint32_t i = 0; i < mCount; i++)
+                        mType.mDestroy(get(i));
+                }
+
+                void* get(uint32_t index)
+                {
+                    return mValues.get() + static_cast<size_t>(index) * mType.mSize;
+                }
+            private:
+                const AttributeType& mType;
+                uint32_t mCount;
+                std::unique_ptr<unsigned char[]> mValues;
+        };
     }
 
-    bool EntityStorage::StorageEntity::hasData(const std::string& attribute) const
+    EntityStorage::EntityStorage(StorageLayout layout) : mLayout(layout), mFrame(0), mConcurrentAccess(0)
     {
-        return attributeData.find(attribute) != attributeData.end();
+        setSerializer<std::string>([] (const std::string& value, SnapshotWriter& writer)
+        {
+            writer.write(value);
+        },
+        [] (std::string& value, SnapshotReader& reader)
+        {
+            value = reader.readString();
+        });
     }
-    
-    std::unordered_set<std::string> EntityStorage::StorageEntity::getAttributes() const
-    {
-        std::unordered_set<std::string> result;
 
-        for(auto& attribute : attributeData)
-            result.insert(attribute.first);
+    EntityStorage::StorageLayout EntityStorage::getLayout() const
+    {
+        return mLayout;
+    }
 
-        return result;
+    EntityId EntityStorage::addEntity(const std::set<std::string>& attributeList)
+    {
+        return addEntity(getAttributeIndices(attributeList));
     }
 
+    EntityId EntityStorage::addEntity(const std::vector<uint32_t>& attributes)
+    {
+        uint32_t archetype = mLayout == ARCHETYPES ? getArchetype(attributes) : 0;
+        uint32_t newId = allocateId();
+        insertEntity(newId, attributes, archetype);
+        return makeEntityId(newId, mGenerations[newId]);
+    }
 
-    EntityStorage::EntityStorage() : mNextId(0)
+    std::vector<EntityId> EntityStorage::addEntities(const std::set<std::string>& attributeList, uint32_t count)
     {
+        return addEntities(getAttributeIndices(attributeList), count);
     }
 
-    uint32_t EntityStorage::addEntity(const std::set<std::string>& attributeList)
+    std::vector<EntityId> EntityStorage::addEntities(const std::vector<uint32_t>& attributes, uint32_t count)
     {
-        uint32_t newId;
+        std::vector<EntityId> result;
+        result.reserve(count);
+        uint32_t archetype = 0;
 
-        if(mFreeIds.size() != 0)
+        //only reserve for batches at least as big as what is stored already, so that repeated small batches still grow the storage geometrically
+        if(mLayout == COLUMNS)
         {
-            newId = mFreeIds.top();
-            mFreeIds.pop();
+            for(uint32_t attribute : attributes)
+            {
+                AttributeColumnBase& column = *mColumns[attribute];
+
+                if(count > column.size())
+                    column.reserve(column.size() + count);
+            }
         }
         else
         {
-            newId = mNextId;
-            mNextId++;
+            archetype = getArchetype(attributes);
+
+            if(count > mArchetypes[archetype]->size())
+                mArchetypes[archetype]->reserve(mArchetypes[archetype]->size() + count);
         }
 
-        for(auto& attribute : attributeList)
+        for(uint32_t i = 0; i < count; i++)
         {
-            FEA_ASSERT(mAttributes.find(attribute) != mAttributes.end(), "Trying to create an entity with the attribute '" + attribute + "' which is invalid!");
+            uint32_t newId = allocateId();
+            insertEntity(newId, attributes, archetype);
+            result.push_back(makeEntityId(newId, mGenerations[newId]));
         }
 
-        mEntities.emplace(newId, StorageEntity(attributeList));
-        return newId;
+        return result;
     }
     
-    void EntityStorage::removeEntity(uint32_t id)
+    void EntityStorage::removeEntity(EntityId entityId)
     {
-        mEntities.erase(id);
-        mFreeIds.push(id);
+        FEA_ASSERT(isValid(entityId), "Trying to remove entity ID '" + std::to_string(entityId) + "' which does not exist!");
+        FEA_ASSERT(!isConcurrentAccess(), "Trying to remove entity ID '" + std::to_string(entityId) + "' during concurrent access! Record the removal using an EntityCommandBuffer instead.");
+        uint32_t id = getEntityIndex(entityId);
+
+        if(mLayout == COLUMNS)
+        {
+            for(auto& query : mQueries)
+                query.second->entityRemoved(id);
+
+            for(auto& column : mColumns)
+            {
+                if(column->has(id))
+                    column->remove(id);
+            }
+        }
+        else
+        {
+            mArchetypes[mEntityArchetypes[id]]->remove(id);
+        }
+
+        for(auto& index : mIndexes)
+            index->remove(id);
+
+        for(auto& shared : mSharedValues)
+        {
+            if(id < shared.size())
+                shared[id] = nullptr;
+        }
+
+        mGenerations[id]++;
+        mFreeIds.push_back(id);
+    }
+
+    void EntityStorage::removeEntities(const std::vector<EntityId>& entityIds)
+    {
+        FEA_ASSERT(!isConcurrentAccess(), "Trying to remove entities during concurrent access! Record the removals using an EntityCommandBuffer instead.");
+        std::vector<uint32_t> ids;
+        ids.reserve(entityIds.size());
+
+        for(EntityId entityId : entityIds)
+        {
+            FEA_ASSERT(isValid(entityId), "Trying to remove entity ID '" + std::to_string(entityId) + "' which does not exist!");
+            ids.push_back(getEntityIndex(entityId));
+        }
+
+        //go through one column or archetype at a time instead of one entity at a time
+        if(mLayout == COLUMNS)
+        {
+            for(auto& query : mQueries)
+            {
+                for(uint32_t id : ids)
+                    query.second->entityRemoved(id);
+            }
+
+            for(auto& column : mColumns)
+            {
+                if(column->size() == 0)
+                    continue;
+
+                for(uint32_t id : ids)
+                {
+                    if(column->has(id))
+                        column->remove(id);
+                }
+            }
+        }
+        else
+        {
+            std::sort(ids.begin(), ids.end(), [&] (uint32_t a, uint32_t b)
+            {
+                return mEntityArchetypes[a] < mEntityArchetypes[b];
+            });
+
+            for(uint32_t id : ids)
+                mArchetypes[mEntityArchetypes[id]]->remove(id);
+        }
+
+        for(auto& index : mIndexes)
+        {
+            for(uint32_t id : ids)
+                index->remove(id);
+        }
+
+        for(auto& shared : mSharedValues)
+        {
+            for(uint32_t id : ids)
+            {
+                if(id < shared.size())
+                    shared[id] = nullptr;
+            }
+        }
+
+        for(uint32_t id : ids)
+        {
+            mGenerations[id]++;
+            mFreeIds.push_back(id);
+        }
+    }
+
+    std::vector<EntityId> EntityStorage::cloneEntity(uint32_t id, uint32_t count)
+    {
+        std::vector<uint32_t> attributes = getEntityAttributes(id);
+
+        for(uint32_t attribute : attributes)
+        {
+            (void)attribute;
+            FEA_ASSERT(mAttributeTypes[attribute].mAssign != nullptr, "Trying to clone an entity with the attribute '" + mAttributeNames[attribute] + "' but its type is not copyable!");
+        }
+
+        std::vector<EntityId> result = addEntities(attributes, count);
+        const EntityStorage& storage = *this;
+
+        //the original is looked up after adding the clones since adding may move it, and values are copied one attribute at a time
+        for(uint32_t attribute : attributes)
+        {
+            const AttributeType& type = mAttributeTypes[attribute];
+
+            if(const void* shared = getSharedValue(id, attribute))
+            {
+                shareValues(result, attribute, shared);
+            }
+            else if(type.mTriviallyCopyable)
+            {
+                const void* source = storage.getValue(id, attribute);
+
+                for(EntityId clone : result)
+                    std::memcpy(getValue(getEntityIndex(clone), attribute), source, type.mSize);
+            }
+            else
+            {
+                const void* source = storage.getValue(id, attribute);
+
+                for(EntityId clone : result)
+                    type.mAssign(getValue(getEntityIndex(clone), attribute), source);
+            }
+        }
+
+        return result;
+    }
+
+    bool EntityStorage::isValid(EntityId id) const
+    {
+        uint32_t index = getEntityIndex(id);
+        return index < mGenerations.size() && mGenerations[index] == getEntityGeneration(id);
     }
 
     bool EntityStorage::hasData(const uint32_t id, const std::string& attribute) const
     {
-        return mEntities.at(id).hasData(attribute); 
+        auto iterator = mAttributes.find(attribute);
+        return iterator != mAttributes.end() && hasData(id, iterator->second);
+    }
+
+    bool EntityStorage::hasData(const uint32_t id, uint32_t attribute) const
+    {
+        if(mLayout == COLUMNS)
+            return mColumns[attribute]->has(id);
+
+        if(id >= mEntityArchetypes.size())
+            return false;
+
+        const Archetype& archetype = *mArchetypes[mEntityArchetypes[id]];
+        return archetype.has(id) && archetype.hasAttribute(attribute);
+    }
+
+    void* EntityStorage::getValue(const uint32_t id, uint32_t attribute)
+    {
+        FEA_ASSERT(hasData(id, attribute), "Trying to get the attribute '" + mAttributeNames[attribute] + "' on an entity which does not have said attribute!");
+
+        if(getSharedValue(id, attribute))
+            unshareValue(id, attribute, true);
+
+        if(mLayout == COLUMNS)
+            return mColumns[attribute]->getValue(id);
+
+        return mArchetypes[mEntityArchetypes[id]]->getValue(id, attribute);
+    }
+
+    const void* EntityStorage::getValue(const uint32_t id, uint32_t attribute) const
+    {
+        FEA_ASSERT(hasData(id, attribute), "Trying to get the attribute '" + mAttributeNames[attribute] + "' on an entity which does not have said attribute!");
+
+        if(const void* shared = getSharedValue(id, attribute))
+            return shared;
+
+        if(mLayout == COLUMNS)
+            return mColumns[attribute]->getValue(id);
+
+        return mArchetypes[mEntityArchetypes[id]]->getValue(id, attribute);
+    }
+
+    void EntityStorage::shareValues(const std::vector<EntityId>& ids, uint32_t attribute, const void* value)
+    {
+        const AttributeType& type = mAttributeTypes[attribute];
+        FEA_ASSERT(type.mAssign != nullptr, "Trying to share a value of attribute '" + mAttributeNames[attribute] + "' but its type is not copyable!");
+
+        bool queried = false;
+
+        for(const auto& query : mQueries)
+            queried = queried || std::find(query.first.begin(), query.first.end(), attribute) != query.first.end();
+
+        if(type.mTriviallyCopyable || queried)
+        {
+            for(EntityId id : ids)
+                type.mAssign(getValue(getEntityIndex(id), attribute), value);
+
+            return;
+        }
+
+        if(attribute >= mSharedValues.size())
+            mSharedValues.resize(attribute + 1);
+
+        std::vector<const void*>& shared = mSharedValues[attribute];
+
+        if(shared.size() < mGenerations.size())
+            shared.resize(mGenerations.size(), nullptr);
+
+        for(EntityId id : ids)
+            shared[getEntityIndex(id)] = value;
+    }
+
+    void EntityStorage::retainSharedValues(std::shared_ptr<const void> owner)
+    {
+        if(std::find(mSharedOwners.begin(), mSharedOwners.end(), owner) == mSharedOwners.end())
+            mSharedOwners.push_back(std::move(owner));
+    }
+
+    const void* EntityStorage::getSharedValue(const uint32_t id, uint32_t attribute) const
+    {
+        return attribute < mSharedValues.size() && id < mSharedValues[attribute].size() ? mSharedValues[attribute][id] : nullptr;
+    }
+
+    void EntityStorage::unshareValue(const uint32_t id, uint32_t attribute, bool copy)
+    {
+        const void* shared = mSharedValues[attribute][id];
+        mSharedValues[attribute][id] = nullptr;
+
+        if(copy)
+            mAttributeTypes[attribute].mAssign(getValue(id, attribute), shared);
+    }
+
+    void EntityStorage::unshareAttribute(uint32_t attribute)
+    {
+        if(attribute >= mSharedValues.size())
+            return;
+
+        for(uint32_t id = 0; id < mSharedValues[attribute].size(); id++)
+        {
+            if(mSharedValues[attribute][id])
+                unshareValue(id, attribute, true);
+        }
+
+        std::vector<const void*>().swap(mSharedValues[attribute]);
     }
 
     bool EntityStorage::attributeIsValid(const std::string& attribute) const
@@ -69,16 +386,671 @@ namespace fea
         return mAttributes.find(attribute) != mAttributes.end();
     }
 
+    uint32_t EntityStorage::getAttributeIndex(const std::string& attribute) const
+    {
+        FEA_ASSERT(mAttributes.find(attribute) != mAttributes.end(), "Trying to access the attribute '" + attribute + "' but such an attribute has not been registered!");
+        return mAttributes.at(attribute);
+    }
+
+    uint32_t EntityStorage::getAttributeCount() const
+    {
+        return static_cast<uint32_t>(mAttributeTypes.size());
+    }
+
+    const AttributeType& EntityStorage::getAttributeType(uint32_t attribute) const
+    {
+        return mAttributeTypes[attribute];
+    }
+
+    void EntityStorage::sortColumns(const EntityQueryBase& query)
+    {
+        FEA_ASSERT(!isConcurrentAccess(), "Trying to sort the attribute columns during concurrent access!");
+
+        const std::vector<uint32_t>& matches = query.mMatches.getIds();
+
+        //every match is swapped into its place once, and the places before it are already taken by earlier matches
+        for(auto column : query.mColumns)
+        {
+            for(uint32_t i = 0; i < matches.size(); i++)
+            {
+                uint32_t index = column->getIndex(matches[i]);
+
+                if(index != i)
+                    column->swap(i, index);
+            }
+        }
+    }
+
+    void EntityStorage::beginConcurrentAccess()
+    {
+        //indexes are not updated during concurrent access, so bring them up to date before it starts
+        if(!isConcurrentAccess())
+        {
+            for(auto& index : mIndexes)
+                refreshIndex(*index);
+        }
+
+        mConcurrentAccess++;
+    }
+
+    void EntityStorage::endConcurrentAccess()
+    {
+        FEA_ASSERT(isConcurrentAccess(), "Trying to end concurrent access but it was never begun!");
+
+        if(--mConcurrentAccess == 0)
+        {
+            for(auto& tracker : mChangeTrackers)
+            {
+                if(tracker)
+                    tracker->trim();
+            }
+        }
+    }
+
+    bool EntityStorage::isConcurrentAccess() const
+    {
+        return mConcurrentAccess.load(std::memory_order_relaxed) != 0;
+    }
+
+    void EntityStorage::trackChanges(uint32_t attribute)
+    {
+        FEA_ASSERT(attribute < mAttributeTypes.size(), "Trying to track changes to an attribute using an invalid index!");
+        FEA_ASSERT(!isConcurrentAccess(), "Trying to start tracking changes to attribute '" + mAttributeNames[attribute] + "' during concurrent access!");
+
+        if(attribute >= mChangeTrackers.size())
+            mChangeTrackers.resize(attribute + 1);
+
+        if(!mChangeTrackers[attribute])
+            mChangeTrackers[attribute].reset(new ChangeTracker(mGenerations));
+    }
+
+    bool EntityStorage::isTrackingChanges(uint32_t attribute) const
+    {
+        return attribute < mChangeTrackers.size() && mChangeTrackers[attribute];
+    }
+
+    void EntityStorage::markChanged(const uint32_t id, uint32_t attribute)
+    {
+        if(isTrackingChanges(attribute))
+            mChangeTrackers[attribute]->markChanged(makeEntityId(id, mGenerations[id]), mFrame, isConcurrentAccess());
+    }
+
+    const ChangeTracker& EntityStorage::getChangeTracker(uint32_t attribute) const
+    {
+        FEA_ASSERT(isTrackingChanges(attribute), "Trying to get the changes to attribute '" + mAttributeNames[attribute] + "' but changes to it are not tracked!");
+        return *mChangeTrackers[attribute];
+    }
+
+    uint32_t EntityStorage::getFrame() const
+    {
+        return mFrame;
+    }
+
+    void EntityStorage::nextFrame()
+    {
+        FEA_ASSERT(!isConcurrentAccess(), "Trying to advance the frame during concurrent access!");
+        mFrame++;
+    }
+
+    void EntityStorage::fillIndex(AttributeIndexBase& index)
+    {
+        uint32_t attribute = index.getAttribute();
+        uint32_t secondary = index.getSecondaryAttribute();
+        const EntityStorage& storage = *this;
+        index.clear();
+
+        if(mLayout == COLUMNS)
+        {
+            for(uint32_t id : mColumns[attribute]->getIds())
+                updateIndex(index, makeEntityId(id, mGenerations[id]));
+        }
+        else
+        {
+            for(auto& archetype : mArchetypes)
+            {
+                if(!archetype->hasAttribute(attribute))
+                    continue;
+
+                bool hasSecondary = secondary != AttributeIndexBase::noAttribute && archetype->hasAttribute(secondary);
+
+                //shared values are not stored in the archetype
+                for(uint32_t id : archetype->getIds())
+                    index.update(makeEntityId(id, mGenerations[id]), storage.getValue(id, attribute), hasSecondary ? storage.getValue(id, secondary) : nullptr);
+            }
+        }
+
+        index.mRefreshedFrame = mFrame;
+        index.mRefreshedMarks = mChangeTrackers[attribute]->getMarkCount();
+
+        if(secondary != AttributeIndexBase::noAttribute)
+            index.mRefreshedSecondaryMarks = mChangeTrackers[secondary]->getMarkCount();
+    }
+
+    void EntityStorage::refreshIndex(AttributeIndexBase& index)
+    {
+        uint32_t attribute = index.getAttribute();
+        uint32_t secondary = index.getSecondaryAttribute();
+        const ChangeTracker& tracker = *mChangeTrackers[attribute];
+        const ChangeTracker* secondaryTracker = secondary != AttributeIndexBase::noAttribute ? mChangeTrackers[secondary].get() : nullptr;
+
+        auto update = [&] (EntityId id)
+        {
+            updateIndex(index, id);
+        };
+
+        //the changes of the frame the index was last refreshed in are visited again, since entities changed twice in one frame are only logged once
+        if(tracker.getMarkCount() != index.mRefreshedMarks)
+        {
+            tracker.forEachChanged(index.mRefreshedFrame, update);
+            index.mRefreshedMarks = tracker.getMarkCount();
+        }
+
+        if(secondaryTracker && secondaryTracker->getMarkCount() != index.mRefreshedSecondaryMarks)
+        {
+            secondaryTracker->forEachChanged(index.mRefreshedFrame, update);
+            index.mRefreshedSecondaryMarks = secondaryTracker->getMarkCount();
+        }
+
+        index.mRefreshedFrame = mFrame;
+    }
+
+    void EntityStorage::updateIndex(AttributeIndexBase& index, EntityId id)
+    {
+        uint32_t entity = getEntityIndex(id);
+        uint32_t attribute = index.getAttribute();
+        uint32_t secondary = index.getSecondaryAttribute();
+
+        const EntityStorage& storage = *this;
+
+        //entities changed through the secondary attribute may lack the indexed one. Values are read through const access to leave shared values shared
+        const void* value = hasData(entity, attribute) ? storage.getValue(entity, attribute) : nullptr;
+        const void* secondaryValue = secondary != AttributeIndexBase::noAttribute && hasData(entity, secondary) ? storage.getValue(entity, secondary) : nullptr;
+
+        if(value)
+            index.update(id, value, secondaryValue);
+        else
+            index.remove(entity);
+    }
+
+    void EntityStorage::writeSnapshot(SnapshotWriter& writer) const
+    {
+        writer.write(snapshotMagic);
+        writer.write(snapshotVersion);
+        writer.write(static_cast<uint32_t>(mGenerations.size()));
+        writer.write(mGenerations.data(), static_cast<uint32_t>(mGenerations.size() * sizeof(uint32_t)));
+        writer.write(static_cast<uint32_t>(mFreeIds.size()));
+        writer.write(mFreeIds.data(), static_cast<uint32_t>(mFreeIds.size() * sizeof(uint32_t)));
+        writer.write(static_cast<uint32_t>(mAttributeTypes.size()));
+
+        //the IDs of every attribute come either from its column or from all archetypes having it
+        std::vector<std::vector<const std::vector<uint32_t>*>> idLists(mAttributeTypes.size());
+        std::vector<uint32_t> counts(mAttributeTypes.size(), 0);
+
+        for(uint32_t attribute = 0; attribute < mAttributeTypes.size(); attribute++)
+        {
+            if(mLayout == COLUMNS)
+            {
+                idLists[attribute].push_back(&mColumns[attribute]->getIds());
+            }
+            else
+            {
+                for(const auto& archetype : mArchetypes)
+                {
+                    if(archetype->hasAttribute(attribute))
+                        idLists[attribute].push_back(&archetype->getIds());
+                }
+            }
+
+            for(auto ids : idLists[attribute])
+                counts[attribute] += static_cast<uint32_t>(ids->size());
+
+            writer.write(mAttributeNames[attribute]);
+            writer.write(mAttributeTypes[attribute].mSize);
+            writer.write(counts[attribute]);
+
+            for(auto ids : idLists[attribute])
+                writer.write(ids->data(), static_cast<uint32_t>(ids->size() * sizeof(uint32_t)));
+        }
+
+        for(uint32_t attribute = 0; attribute < mAttributeTypes.size(); attribute++)
+        {
+            const AttributeType& type = mAttributeTypes[attribute];
+            auto serializer = mSerializers.find(type.mType);
+
+            if(serializer != mSerializers.end())
+            {
+                for(auto ids : idLists[attribute])
+                {
+                    for(uint32_t id : *ids)
+                        serializer->second.mWrite(getValue(id, attribute), writer);
+                }
+            }
+            else
+            {
+                FEA_ASSERT(type.mTriviallyCopyable, "Trying to write attribute '" + mAttributeNames[attribute] + "' to a snapshot but its type is not trivially copyable and has no serializer!");
+                uint8_t* destination = writer.allocate(counts[attribute] * type.mSize);
+
+                for(auto ids : idLists[attribute])
+                {
+                    for(uint32_t id : *ids)
+                    {
+                        std::memcpy(destination, getValue(id, attribute), type.mSize);
+                        destination += type.mSize;
+                    }
+                }
+            }
+        }
+    }
+
+    bool EntityStorage::readSnapshot(SnapshotReader& reader, std::vector<EntityId>& ids)
+    {
+        FEA_ASSERT(!isConcurrentAccess(), "Trying to read a snapshot during concurrent access!");
+
+        //the whole snapshot is read and checked before anything is changed, so that data which is truncated, corrupt or written by a manager with other attributes leaves the storage as it was
+        if(reader.read<uint32_t>() != snapshotMagic || reader.read<uint32_t>() != snapshotVersion)
+            return false;
+
+        std::vector<uint32_t> generations;
+        std::vector<uint32_t> freeIds;
+
+        if(!readSnapshotIds(reader, generations) || !readSnapshotIds(reader, freeIds))
+            return false;
+
+        uint32_t slotCount = static_cast<uint32_t>(generations.size());
+        std::vector<uint8_t> alive(slotCount, 1);
+
+        for(uint32_t id : freeIds)
+        {
+            if(id >= slotCount || !alive[id])
+                return false;
+
+            alive[id] = 0;
+        }
+
+        uint32_t attributeCount = reader.read<uint32_t>();
+
+        if(attributeCount > mAttributeTypes.size())
+            return false;
+
+        std::vector<uint32_t> attributes(attributeCount);
+        std::vector<std::vector<uint32_t>> idLists(attributeCount);
+        std::vector<uint8_t> attributeRead(mAttributeTypes.size(), 0);
+        std::vector<uint32_t> lastAttribute(slotCount, attributeCount);
+
+        for(uint32_t i = 0; i < attributeCount; i++)
+        {
+            std::string name = reader.readString();
+            uint32_t size = reader.read<uint32_t>();
+            auto attribute = mAttributes.find(name);
+
+            if(attribute == mAttributes.end() || attributeRead[attribute->second] || size != mAttributeTypes[attribute->second].mSize || !readSnapshotIds(reader, idLists[i]))
+                return false;
+
+            attributes[i] = attribute->second;
+            attributeRead[attributes[i]] = 1;
+
+            for(uint32_t id : idLists[i])
+            {
+                if(id >= slotCount || !alive[id] || lastAttribute[id] == i)
+                    return false;
+
+                lastAttribute[id] = i;
+            }
+        }
+
+        //the bytes of trivially copyable values are only located, while values read by a serializer are read into temporary values which are moved into place once the snapshot is known to be complete
+        std::vector<const uint8_t*> rawValues(attributeCount, nullptr);
+        std::vector<std::unique_ptr<SnapshotValues>> readValues(attributeCount);
+
+        for(uint32_t i = 0; i < attributeCount; i++)
+        {
+            const AttributeType& type = mAttributeTypes[attributes[i]];
+            auto serializer = mSerializers.find(type.mType);
+            uint32_t count = static_cast<uint32_t>(idLists[i].size());
+
+            if(serializer != mSerializers.end())
+            {
+                readValues[i].reset(new SnapshotValues(type, count));
+
+                for(uint32_t v = 0; v < count && !reader.hasFailed(); v++)
+                    serializer->second.mRead(readValues[i]->get(v), reader);
+            }
+            else
+            {
+                FEA_ASSERT(type.mTriviallyCopyable, "Trying to read attribute '" + mAttributeNames[attributes[i]] + "' from a snapshot but its type is not trivially copyable and has no serializer!");
+                uint64_t byteCount = static_cast<uint64_t>(count) * type.mSize;
+
+                if(!type.mTriviallyCopyable || byteCount > reader.getRemainingSize() || byteCount > std::numeric_limits<uint32_t>::max())
+                    return false;
+
+                rawValues[i] = reader.skip(static_cast<uint32_t>(byteCount));
+            }
+        }
+
+        if(reader.hasFailed() || !reader.isAtEnd())
+            return false;
+
+        //snapshots hold copies of all values, so nothing is shared after reading one
+        mSharedValues.clear();
+        mSharedOwners.clear();
+
+        if(mLayout == COLUMNS)
+        {
+            for(auto& query : mQueries)
+                query.second->mMatches.clear();
+
+            for(auto& column : mColumns)
+                column->clear();
+        }
+        else
+        {
+            for(auto& archetype : mArchetypes)
+                archetype->clear();
+        }
+
+        mGenerations.swap(generations);
+        mFreeIds.swap(freeIds);
+
+        //changes of slots the snapshot does not have would otherwise be reported for entities which do not exist
+        for(auto& tracker : mChangeTrackers)
+        {
+            if(tracker)
+                tracker->truncate(slotCount);
+        }
+
+        ids.clear();
+        ids.reserve(slotCount - mFreeIds.size());
+
+        if(mLayout == COLUMNS)
+        {
+            for(uint32_t i = 0; i < attributeCount; i++)
+            {
+                AttributeColumnBase& column = *mColumns[attributes[i]];
+                column.reserve(static_cast<uint32_t>(idLists[i].size()));
+
+                for(uint32_t id : idLists[i])
+                    column.add(id);
+
+                if(isTrackingChanges(attributes[i]))
+                {
+                    for(uint32_t id : idLists[i])
+                        markChanged(id, attributes[i]);
+                }
+            }
+
+            for(uint32_t id = 0; id < slotCount; id++)
+            {
+                if(!alive[id])
+                    continue;
+
+                for(auto& query : mQueries)
+                    query.second->entityCreated(id);
+
+                ids.push_back(makeEntityId(id, mGenerations[id]));
+            }
+        }
+        else
+        {
+            //gather the attributes of every entity into one flat array, indexed by slot
+            std::vector<uint32_t> offsets(slotCount + 1, 0);
+
+            for(const auto& idList : idLists)
+            {
+                for(uint32_t id : idList)
+                    offsets[id + 1]++;
+            }
+
+            for(uint32_t id = 0; id < slotCount; id++)
+                offsets[id + 1] += offsets[id];
+
+            std::vector<uint32_t> entityAttributes(offsets.back());
+            std::vector<uint32_t> positions(offsets.begin(), offsets.end() - 1);
+
+            for(uint32_t i = 0; i < attributeCount; i++)
+            {
+                for(uint32_t id : idLists[i])
+                    entityAttributes[positions[id]++] = attributes[i];
+            }
+
+            //neighbouring entities usually share their attributes, so the archetype is only looked up when they change
+            std::vector<uint32_t> current;
+            std::vector<uint32_t> previous;
+            uint32_t archetype = 0;
+            bool first = true;
+
+            for(uint32_t id = 0; id < slotCount; id++)
+            {
+                if(!alive[id])
+                    continue;
+
+                current.assign(entityAttributes.begin() + offsets[id], entityAttributes.begin() + offsets[id + 1]);
+                std::sort(current.begin(), current.end());
+
+                if(first || current != previous)
+                {
+                    archetype = getArchetype(current);
+                    previous.swap(current);
+                    first = false;
+                }
+
+                insertEntity(id, mArchetypes[archetype]->getAttributes(), archetype);
+                ids.push_back(makeEntityId(id, mGenerations[id]));
+            }
+        }
+
+        for(uint32_t i = 0; i < attributeCount; i++)
+        {
+            uint32_t attribute = attributes[i];
+            const AttributeType& type = mAttributeTypes[attribute];
+
+            for(uint32_t v = 0; v < idLists[i].size(); v++)
+            {
+                void* destination = getValue(idLists[i][v], attribute);
+
+                if(readValues[i])
+                {
+                    type.mDestroy(destination);
+                    type.mMove(destination, readValues[i]->get(v));
+                }
+                else
+                {
+                    std::memcpy(destination, rawValues[i] + v * type.mSize, type.mSize);
+                }
+            }
+        }
+
+        for(auto& index : mIndexes)
+            fillIndex(*index);
+
+        return true;
+    }
+
+    void EntityStorage::getStats(EntityStats& stats) const
+    {
+        stats.mEntityCount = static_cast<uint32_t>(mGenerations.size() - mFreeIds.size());
+        stats.mSlotCount = static_cast<uint32_t>(mGenerations.size());
+        stats.mFreeIdCount = static_cast<uint32_t>(mFreeIds.size());
+        stats.mReservedIdBytes = (mGenerations.capacity() + mFreeIds.capacity() + mEntityArchetypes.capacity()) * sizeof(uint32_t);
+        stats.mArchetypeCount = static_cast<uint32_t>(mArchetypes.size());
+        stats.mUsedChunkCount = mChunkPool.getUsedCount();
+        stats.mFreeChunkCount = mChunkPool.getFreeCount();
+        stats.mReservedChunkBytes = mChunkPool.getReservedBytes();
+        stats.mAttributeLoadFactor = mAttributes.load_factor();
+        stats.mSerializerLoadFactor = mSerializers.load_factor();
+
+        //the vector and the names are assigned rather than rebuilt, so that filling in the same stats every frame does not allocate
+        stats.mAttributes.resize(mAttributeTypes.size());
+
+        for(uint32_t attribute = 0; attribute < mAttributeTypes.size(); attribute++)
+        {
+            AttributeStats& attributeStats = stats.mAttributes[attribute];
+            attributeStats.mName = mAttributeNames[attribute];
+            attributeStats.mCount = 0;
+            attributeStats.mReservedBytes = 0;
+            attributeStats.mAllocationCount = 0;
+
+            if(mLayout == COLUMNS)
+            {
+                const AttributeColumnBase& column = *mColumns[attribute];
+                attributeStats.mCount = column.size();
+                attributeStats.mReservedBytes = static_cast<uint64_t>(column.capacity()) * mAttributeTypes[attribute].mSize;
+                attributeStats.mAllocationCount = column.getAllocationCount();
+                stats.mReservedIdBytes += column.getReservedIdBytes();
+            }
+        }
+
+        if(mLayout == ARCHETYPES)
+        {
+            for(const auto& archetype : mArchetypes)
+            {
+                for(uint32_t attribute : archetype->getAttributes())
+                {
+                    AttributeStats& attributeStats = stats.mAttributes[attribute];
+                    attributeStats.mCount += archetype->size();
+                    attributeStats.mReservedBytes += static_cast<uint64_t>(archetype->getChunkCount()) * archetype->getChunkCapacity() * mAttributeTypes[attribute].mSize;
+                    attributeStats.mAllocationCount += archetype->getChunkCount();
+                }
+
+                stats.mReservedIdBytes += archetype->getReservedIdBytes();
+            }
+        }
+
+        for(uint32_t attribute = 0; attribute < mAttributeTypes.size(); attribute++)
+            stats.mAttributes[attribute].mUsedBytes = static_cast<uint64_t>(stats.mAttributes[attribute].mCount) * mAttributeTypes[attribute].mSize;
+    }
+
     void EntityStorage::clear()
     {
+        FEA_ASSERT(!isConcurrentAccess(), "Trying to clear the entity storage during concurrent access!");
         mAttributes.clear();
-        mEntities.clear();
-        mFreeIds = std::stack<uint32_t>();
-        mNextId = 0;
+        mAttributeNames.clear();
+        mAttributeTypes.clear();
+        mQueries.clear();
+        mIndexes.clear();
+        mChangeTrackers.clear();
+        mSharedValues.clear();
+        mSharedOwners.clear();
+        mColumns.clear();
+        mArchetypes.clear();
+        mChunkPool.clear();
+        mArchetypeIndices.clear();
+        mEntityArchetypes.clear();
+        mFreeIds.clear();
+
+        //keep the generations so that IDs from before the clear stay invalid
+        for(uint32_t id = static_cast<uint32_t>(mGenerations.size()); id > 0; id--)
+        {
+            if(mGenerations[id - 1] % 2 == 0)
+                mGenerations[id - 1]++;
+
+            mFreeIds.push_back(id - 1);
+        }
     }
     
     std::unordered_set<std::string> EntityStorage::getAttributes(uint32_t id) const
     {
-        return mEntities.at(id).getAttributes();
+        std::unordered_set<std::string> result;
+
+        for(uint32_t i = 0; i < mColumns.size(); i++)
+        {
+            if(hasData(id, i))
+                result.insert(mAttributeNames[i]);
+        }
+
+        return result;
+    }
+
+    std::vector<uint32_t> EntityStorage::getEntityAttributes(uint32_t id) const
+    {
+        if(mLayout == ARCHETYPES)
+            return mArchetypes[mEntityArchetypes[id]]->getAttributes();
+
+        std::vector<uint32_t> attributes;
+
+        for(uint32_t attribute = 0; attribute < mColumns.size(); attribute++)
+        {
+            if(mColumns[attribute]->has(id))
+                attributes.push_back(attribute);
+        }
+
+        return attributes;
+    }
+
+    std::vector<uint32_t> EntityStorage::getAttributeIndices(const std::set<std::string>& attributeList) const
+    {
+        std::vector<uint32_t> attributes;
+        attributes.reserve(attributeList.size());
+
+        for(auto& attribute : attributeList)
+        {
+            FEA_ASSERT(mAttributes.find(attribute) != mAttributes.end(), "Trying to create an entity with the attribute '" + attribute + "' which is invalid!");
+            attributes.push_back(mAttributes.at(attribute));
+        }
+
+        std::sort(attributes.begin(), attributes.end());
+        return attributes;
+    }
+
+    uint32_t EntityStorage::allocateId()
+    {
+        FEA_ASSERT(!isConcurrentAccess(), "Trying to create an entity during concurrent access! Record the creation using an EntityCommandBuffer instead.");
+        uint32_t newId;
+
+        if(mFreeIds.size() != 0)
+        {
+            newId = mFreeIds.back();
+            mFreeIds.pop_back();
+            mGenerations[newId]++;
+        }
+        else
+        {
+            newId = static_cast<uint32_t>(mGenerations.size());
+            mGenerations.push_back(0);
+        }
+
+        return newId;
+    }
+
+    void EntityStorage::insertEntity(uint32_t id, const std::vector<uint32_t>& attributes, uint32_t archetype)
+    {
+        if(mLayout == COLUMNS)
+        {
+            for(uint32_t attribute : attributes)
+                mColumns[attribute]->add(id);
+
+            for(auto& query : mQueries)
+                query.second->entityCreated(id);
+        }
+        else
+        {
+            if(id >= mEntityArchetypes.size())
+                mEntityArchetypes.resize(id + 1);
+
+            mEntityArchetypes[id] = archetype;
+            mArchetypes[archetype]->add(id);
+        }
+
+        if(!mChangeTrackers.empty())
+        {
+            for(uint32_t attribute : attributes)
+                markChanged(id, attribute);
+        }
+    }
+
+    uint32_t EntityStorage::getArchetype(const std::vector<uint32_t>& attributes)
+    {
+        auto iterator = mArchetypeIndices.find(attributes);
+
+        if(iterator != mArchetypeIndices.end())
+            return iterator->second;
+
+        uint32_t index = static_cast<uint32_t>(mArchetypes.size());
+        mArchetypes.emplace_back(new Archetype(attributes, mAttributeTypes, mChunkPool));
+        mArchetypeIndices.emplace(attributes, index);
+
+        for(auto& query : mQueries)
+            query.second->archetypeCreated(*mArchetypes.back());
+
+        return index;
     }
 }
@@ -1,5 +1,6 @@
 #include <fea/entity/jsonentityloader.hpp>
 #include <fstream>
+#include <iterator>
 #include <json/reader.h>
 #include <json/value.h>
 
@@ -17,16 +18,80 @@ namespace fea
 
     std::vector<std::pair<std::string, EntityTemplate>> JsonEntityLoader::loadEntityTemplates(const std::string& path)
     {
-        std::ifstream file(path);
+        return parseEntityTemplates(readFile(path));
+    }
+
+    void JsonEntityLoader::loadEntityTemplates(const std::vector<std::string>& paths, EntityFactory& factory, const std::string& cachePath)
+    {
+        //64 bit FNV-1a over the paths and contents of all files, in order
+        uint64_t hash = 14695981039346656037ull;
+        auto addToHash = [&hash] (const std::string& data)
+        {
+            for(char character : data)
+            {
+                hash ^= static_cast<uint8_t>(character);
+                hash *= 1099511628211ull;
+            }
+
+            hash ^= data.size();
+            hash *= 1099511628211ull;
+        };
+
+        std::vector<std::string> sources;
+
+        for(const auto& path : paths)
+        {
+            sources.push_back(readFile(path));
+            addToHash(path);
+            addToHash(sources.back());
+        }
+
+        std::vector<uint8_t> cache;
+        std::ifstream cacheFile(cachePath, std::ios::binary);
+
+        if(cacheFile)
+        {
+            cache.assign(std::istreambuf_iterator<char>(cacheFile), std::istreambuf_iterator<char>());
+            cacheFile.close();
+
+            if(factory.loadTemplateCache(cache, hash))
+                return;
+        }
+
+        std::vector<std::string> names;
+
+        for(const auto& source : sources)
+        {
+            for(const auto& entityTemplate : parseEntityTemplates(source))
+            {
+                factory.addTemplate(entityTemplate.first, entityTemplate.second);
+                names.push_back(entityTemplate.first);
+            }
+        }
+
+        if(factory.saveTemplateCache(names, hash, cache))
+        {
+            std::ofstream output(cachePath, std::ios::binary | std::ios::trunc);
+            output.write(reinterpret_cast<const char*>(cache.data()), static_cast<std::streamsize>(cache.size()));
+        }
+    }
+
+    std::string JsonEntityLoader::readFile(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
 
         if(!file)
             throw FileNotFoundException("Error! Entity file not found: " + path + '\n');
 
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    std::vector<std::pair<std::string, EntityTemplate>> JsonEntityLoader::parseEntityTemplates(const std::string& source)
+    {
         Json::Value root;
         Json::Reader reader;
 
-        reader.parse(file, root, false);
-        file.close();
+        reader.parse(source, root, false);
 
         std::vector<std::pair<std::string, EntityTemplate>> result;
 
@@ -0,0 +1,83 @@
+#include <fea/entity/sparseset.hpp>
+#include <fea/assert.hpp>
+#include <string>
+#include <utility>
+
+namespace fea
+{
+    bool SparseSet::has(uint32_t id) const
+    {
+        if(id >= mSparse.size())
+            return false;
+
+        uint32_t index = mSparse[id];
+        return index < mDense.size() && mDense[index] == id;
+    }
+
+    uint32_t SparseSet::insert(uint32_t id)
+    {
+        FEA_ASSERT(!has(id), "Trying to insert ID '" + std::to_string(id) + "' in a sparse set which already contains it!");
+
+        if(id >= mSparse.size())
+            mSparse.resize(id + 1);
+
+        uint32_t index = static_cast<uint32_t>(mDense.size());
+        mSparse[id] = index;
+        mDense.push_back(id);
+        return index;
+    }
+
+    uint32_t SparseSet::erase(uint32_t id)
+    {
+        FEA_ASSERT(has(id), "Trying to erase ID '" + std::to_string(id) + "' from a sparse set which does not contain it!");
+
+        uint32_t index = mSparse[id];
+        uint32_t last = mDense.back();
+
+        mDense[index] = last;
+        mSparse[last] = index;
+        mDense.pop_back();
+        return index;
+    }
+
+    uint32_t SparseSet::getIndex(uint32_t id) const
+    {
+        FEA_ASSERT(has(id), "Trying to get the index of ID '" + std::to_string(id) + "' in a sparse set which does not contain it!");
+        return mSparse[id];
+    }
+
+    void SparseSet::swap(uint32_t first, uint32_t second)
+    {
+        FEA_ASSERT(first < mDense.size() && second < mDense.size(), "Trying to swap dense index '" + std::to_string(first) + "' and '" + std::to_string(second) + "' in a sparse set of size '" + std::to_string(mDense.size()) + "'!");
+
+        std::swap(mDense[first], mDense[second]);
+        mSparse[mDense[first]] = first;
+        mSparse[mDense[second]] = second;
+    }
+
+    uint32_t SparseSet::size() const
+    {
+        return static_cast<uint32_t>(mDense.size());
+    }
+
+    const std::vector<uint32_t>& SparseSet::getIds() const
+    {
+        return mDense;
+    }
+
+    void SparseSet::reserve(uint32_t amount)
+    {
+        mDense.reserve(amount);
+    }
+
+    void SparseSet::clear()
+    {
+        mSparse.clear();
+        mDense.clear();
+    }
+
+    uint64_t SparseSet::getReservedBytes() const
+    {
+        return (mSparse.capacity() + mDense.capacity()) * sizeof(uint32_t);
+    }
+}
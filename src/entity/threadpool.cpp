@@ -0,0 +1,153 @@
+#include <fea/entity/threadpool.hpp>
+
+namespace fea
+{
+    namespace
+    {
+        thread_local const ThreadPool* currentPool = nullptr;
+        thread_local uint32_t currentQueue = 0;
+    }
+
+    ThreadPool::TaskGroup::TaskGroup() : mPending(0)
+    {
+    }
+
+    bool ThreadPool::TaskGroup::isDone() const
+    {
+        return mPending == 0;
+    }
+
+    ThreadPool::ThreadPool(uint32_t workerCount) : mQueuedTasks(0), mStop(false)
+    {
+        //one queue per worker and a shared one for threads outside of the pool
+        for(uint32_t i = 0; i <= workerCount; i++)
+            mQueues.emplace_back(new Queue());
+
+        for(uint32_t i = 0; i < workerCount; i++)
+            mWorkers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+            mStop = true;
+        }
+
+        mSleepCondition.notify_all();
+
+        for(auto& worker : mWorkers)
+            worker.join();
+    }
+
+    uint32_t ThreadPool::getWorkerCount() const
+    {
+        return static_cast<uint32_t>(mWorkers.size());
+    }
+
+    void ThreadPool::run(TaskGroup& group, std::function<void()> task)
+    {
+        group.mPending++;
+
+        Queue& queue = *mQueues[getCurrentQueue()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mMutex);
+            queue.mTasks.push_back(Task{std::move(task), &group});
+        }
+
+        mQueuedTasks++;
+
+        {
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+        }
+
+        mSleepCondition.notify_one();
+    }
+
+    void ThreadPool::wait(TaskGroup& group)
+    {
+        uint32_t queue = getCurrentQueue();
+
+        while(!group.isDone())
+        {
+            if(!runTask(queue))
+                std::this_thread::yield();
+        }
+    }
+
+    uint32_t ThreadPool::getDefaultWorkerCount()
+    {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+
+    uint32_t ThreadPool::getCurrentQueue() const
+    {
+        return currentPool == this ? currentQueue : static_cast<uint32_t>(mQueues.size() - 1);
+    }
+
+    bool ThreadPool::popTask(uint32_t queue, Task& task)
+    {
+        if(mQueuedTasks == 0)
+            return false;
+
+        {
+            Queue& own = *mQueues[queue];
+            std::lock_guard<std::mutex> lock(own.mMutex);
+
+            if(!own.mTasks.empty())
+            {
+                task = std::move(own.mTasks.back());
+                own.mTasks.pop_back();
+                mQueuedTasks--;
+                return true;
+            }
+        }
+
+        for(uint32_t offset = 1; offset < mQueues.size(); offset++)
+        {
+            Queue& other = *mQueues[(queue + offset) % mQueues.size()];
+            std::lock_guard<std::mutex> lock(other.mMutex);
+
+            if(!other.mTasks.empty())
+            {
+                task = std::move(other.mTasks.front());
+                other.mTasks.pop_front();
+                mQueuedTasks--;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool ThreadPool::runTask(uint32_t queue)
+    {
+        Task task;
+
+        if(!popTask(queue, task))
+            return false;
+
+        task.mFunction();
+        task.mGroup->mPending--;
+        return true;
+    }
+
+    void ThreadPool::workerLoop(uint32_t queue)
+    {
+        currentPool = this;
+        currentQueue = queue;
+
+        while(true)
+        {
+            if(runTask(queue))
+                continue;
+
+            std::unique_lock<std::mutex> lock(mSleepMutex);
+            mSleepCondition.wait(lock, [this] () { return mStop || mQueuedTasks > 0; });
+
+            if(mStop && mQueuedTasks == 0)
+                return;
+        }
+    }
+}
@@ -1,30 +1,490 @@
 #include <fea/util/messagebus.hpp>
+#include <atomic>
+#if defined(FEA_MESSAGE_STATS) && defined(__GNUG__)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
 
 namespace fea
 {
-    MessageBus::MessageBus()
+    namespace
     {
+        std::atomic<uint64_t> nextInstance(0);
+        std::atomic<uint32_t> nextTypeId(0);
+        const uint32_t noQueue = static_cast<uint32_t>(-1);
+
+        //the post queues of the last bus this thread posted to, so that posting does not need the lock guarding the list of queues
+        thread_local uint64_t cachedInstance = static_cast<uint64_t>(-1);
+        thread_local void* cachedQueues = nullptr;
+
+        //the bus whose dispatched messages this thread is handling, if any, so that dispatching from within a handler can be caught
+        thread_local const void* dispatchingBus = nullptr;
+
+#if defined(FEA_MESSAGE_STATS)
+        std::string demangle(const char* name)
+        {
+#if defined(__GNUG__)
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+
+            if(status == 0)
+            {
+                std::string result(demangled);
+                std::free(demangled);
+                return result;
+            }
+#endif
+            //MSVC type names are already readable
+            return name;
+        }
+#endif
+    }
+
+    uint32_t nextMessageTypeId()
+    {
+        return nextTypeId++;
+    }
+
+    MessageQueueBase::MessageQueueBase(uint32_t typeId) : mTypeId(typeId)
+    {
+    }
+
+    MessageQueueBase::~MessageQueueBase()
+    {
+    }
+
+    uint32_t MessageQueueBase::getTypeId() const
+    {
+        return mTypeId;
+    }
+
+    MessageBus::SubscriberList::SubscriberList() : mDeliveries(0), mRemovedCount(0)
+    {
+    }
+
+    MessageBus::MessageBus() : mInstance(nextInstance++)
+    {
+    }
+
+    void MessageBus::dispatch()
+    {
+        FEA_ASSERT(!isDispatching(), "Cannot dispatch from a handler of a dispatched message!");
+        std::lock_guard<std::mutex> dispatchLock(mDispatchMutex);
+        std::lock_guard<std::recursive_mutex> lock(mSubscribersMutex);
+        collectPosted();
+        deliverPosted(false);
+    }
+
+    uint32_t MessageBus::addSubscription(uint32_t typeId, const char* typeName, MessageReceiverBase* receiver, bool threadSafe, int32_t priority, uint32_t& generation)
+    {
+        std::lock_guard<std::recursive_mutex> lock(mSubscribersMutex);
+
+        if(typeId >= mSubscribers.size())
+            mSubscribers.resize(typeId + 1);
+
+        SubscriberList& list = mSubscribers[typeId];
+        auto isReceiver = [&] (const Subscription& subscription) { return subscription.mReceiver == receiver; };
+        (void)isReceiver;
+        (void)typeName;
+
+        FEA_ASSERT(std::none_of(list.mSubscriptions.begin(), list.mSubscriptions.end(), isReceiver) && std::none_of(list.mPending.begin(), list.mPending.end(), isReceiver), "Message receiver already subscribes to message " + std::string(typeName) + "!");
+
+        uint32_t slot;
+
+        if(list.mFreeSlots.empty())
+        {
+            slot = static_cast<uint32_t>(list.mSlots.size());
+            list.mSlots.push_back(Slot{0, 0, false});
+        }
+        else
+        {
+            slot = list.mFreeSlots.back();
+            list.mFreeSlots.pop_back();
+        }
+
+        Subscription subscription{receiver, priority, threadSafe, slot};
+
+        //inserting would shift the subscribers a delivery in progress is iterating over, so the subscription waits until the delivery is done
+        if(list.mDeliveries > 0)
+        {
+            list.mSlots[slot].mPosition = static_cast<uint32_t>(list.mPending.size());
+            list.mSlots[slot].mPending = true;
+            list.mPending.push_back(subscription);
+        }
+        else
+        {
+            insertSubscription(list, subscription);
+        }
+
+        generation = list.mSlots[slot].mGeneration;
+        return slot;
     }
 
-    bool MessageBus::subscriptionExists(std::type_index id, MessageReceiverBase* receiver) const
+    bool MessageBus::removeSubscription(uint32_t typeId, const char* typeName, MessageReceiverBase* receiver)
     {
-        const auto listIterator = mSubscribers.find(id);
+        std::lock_guard<std::recursive_mutex> lock(mSubscribersMutex);
+        (void)typeName;
 
-        if(listIterator == mSubscribers.end())
+        FEA_ASSERT(typeId < mSubscribers.size(), "Cannot remove subscription to message " + std::string(typeName) + " since the subscription does not exist!");
+
+        if(typeId >= mSubscribers.size())
+            return false;
+
+        SubscriberList& list = mSubscribers[typeId];
+        auto isReceiver = [&] (const Subscription& subscription) { return subscription.mReceiver == receiver; };
+        auto subscription = std::find_if(list.mSubscriptions.begin(), list.mSubscriptions.end(), isReceiver);
+
+        if(subscription != list.mSubscriptions.end())
+        {
+            removeSlot(list, subscription->mSlot);
+            return true;
+        }
+
+        subscription = std::find_if(list.mPending.begin(), list.mPending.end(), isReceiver);
+
+        FEA_ASSERT(subscription != list.mPending.end(), "Cannot remove subscription to message " + std::string(typeName) + " since the subscription does not exist!");
+
+        if(subscription == list.mPending.end())
+            return false;
+
+        removeSlot(list, subscription->mSlot);
+        return true;
+    }
+
+    bool MessageBus::removeSubscription(uint32_t typeId, uint32_t slot, uint32_t generation)
+    {
+        std::lock_guard<std::recursive_mutex> lock(mSubscribersMutex);
+
+        //a token outlives its subscription when the receiver was also removed by other means, and the slot may since have been given to another receiver
+        if(typeId >= mSubscribers.size() || slot >= mSubscribers[typeId].mSlots.size() || mSubscribers[typeId].mSlots[slot].mGeneration != generation)
             return false;
 
-        const auto& list = listIterator->second;
-        bool existed = false;
+        removeSlot(mSubscribers[typeId], slot);
+        return true;
+    }
+
+    void MessageBus::removeSlot(SubscriberList& list, uint32_t slot)
+    {
+        //the subscription is only cleared, since erasing would shift the subscribers a delivery in progress may be iterating over. Cleared subscriptions are erased in one pass once they make up half of the list
+        Slot& removed = list.mSlots[slot];
+
+        if(removed.mPending)
+        {
+            list.mPending[removed.mPosition].mReceiver = nullptr;
+        }
+        else
+        {
+            list.mSubscriptions[removed.mPosition].mReceiver = nullptr;
+            list.mRemovedCount++;
+        }
+
+        removed.mGeneration++;
+        list.mFreeSlots.push_back(slot);
+
+        if(list.mDeliveries == 0 && list.mRemovedCount * 2 > list.mSubscriptions.size())
+            compact(list);
+    }
+
+    void MessageBus::insertSubscription(SubscriberList& list, const Subscription& subscription)
+    {
+        //higher priorities come first, and subscriptions of equal priority keep the order they were added in
+        auto position = std::upper_bound(list.mSubscriptions.begin(), list.mSubscriptions.end(), subscription, [] (const Subscription& a, const Subscription& b) { return a.mPriority > b.mPriority; });
+        position = list.mSubscriptions.insert(position, subscription);
+
+        for(auto moved = position; moved != list.mSubscriptions.end(); ++moved)
+        {
+            if(moved->mReceiver)
+            {
+                list.mSlots[moved->mSlot].mPosition = static_cast<uint32_t>(moved - list.mSubscriptions.begin());
+                list.mSlots[moved->mSlot].mPending = false;
+            }
+        }
+    }
+
+    void MessageBus::compact(SubscriberList& list)
+    {
+        uint32_t position = 0;
+
+        for(const auto& subscription : list.mSubscriptions)
+        {
+            if(subscription.mReceiver)
+            {
+                list.mSlots[subscription.mSlot].mPosition = position;
+                list.mSubscriptions[position++] = subscription;
+            }
+        }
+
+        list.mSubscriptions.resize(position);
+        list.mRemovedCount = 0;
+    }
+
+    void MessageBus::endDelivery(SubscriberList& list)
+    {
+        list.mDeliveries--;
+
+        if(list.mDeliveries == 0 && !list.mPending.empty())
+        {
+            for(const auto& subscription : list.mPending)
+            {
+                if(subscription.mReceiver)
+                    insertSubscription(list, subscription);
+            }
+
+            list.mPending.clear();
+        }
+
+        if(list.mDeliveries == 0 && list.mRemovedCount * 2 > list.mSubscriptions.size())
+            compact(list);
+    }
+
+    MessageBus::PostQueues& MessageBus::getPostQueues()
+    {
+        if(cachedInstance == mInstance)
+            return *static_cast<PostQueues*>(cachedQueues);
+
+        std::lock_guard<std::mutex> lock(mPostQueuesMutex);
+        std::thread::id thread = std::this_thread::get_id();
+
+        auto iterator = std::find_if(mPostQueues.begin(), mPostQueues.end(), [&] (const std::unique_ptr<PostQueues>& queues)
+        {
+            return queues->mThread == thread;
+        });
+
+        if(iterator == mPostQueues.end())
+        {
+            mPostQueues.emplace_back(new PostQueues());
+            mPostQueues.back()->mThread = thread;
+            iterator = mPostQueues.end() - 1;
+        }
+
+        cachedInstance = mInstance;
+        cachedQueues = iterator->get();
+        return **iterator;
+    }
+
+    void MessageBus::collectPosted()
+    {
+        //everything is set aside before delivering anything, so that messages posted by subscribers wait for the next dispatch regardless of their type
+        std::lock_guard<std::mutex> lock(mPostQueuesMutex);
+
+        for(auto& queues : mPostQueues)
+        {
+            std::lock_guard<std::mutex> queuesLock(queues->mMutex);
+
+            for(auto& queue : queues->mQueues)
+            {
+                if(!queue || queue->isEmpty())
+                    continue;
+
+                uint32_t typeId = queue->getTypeId();
+
+                if(typeId >= mQueueIndices.size())
+                    mQueueIndices.resize(typeId + 1, noQueue);
+
+                if(mQueueIndices[typeId] == noQueue)
+                {
+                    mQueueIndices[typeId] = static_cast<uint32_t>(mQueues.size());
+                    mQueues.emplace_back(queue->createQueue());
+                }
+
+                queue->moveTo(*mQueues[mQueueIndices[typeId]]);
+            }
+        }
+    }
+
+    void MessageBus::gatherThreadSafeDeliveries()
+    {
+        for(const auto& queue : mQueues)
+        {
+            uint32_t typeId = queue->getTypeId();
+
+            if(queue->isEmpty() || typeId >= mSubscribers.size())
+                continue;
+
+            SubscriberList& list = mSubscribers[typeId];
+
+            for(uint32_t i = 0; i < list.mSubscriptions.size(); i++)
+            {
+                if(list.mSubscriptions[i].mReceiver && list.mSubscriptions[i].mThreadSafe)
+                {
+                    Delivery delivery;
+                    delivery.mQueue = queue.get();
+                    delivery.mReceiver = list.mSubscriptions[i].mReceiver;
+                    delivery.mPosition = i;
+                    mThreadSafeDeliveries.push_back(delivery);
+
+                    //every delivery counts as in progress until the dispatch is done, which keeps the subscriptions in place for the thread pool, since additions wait and removals only clear the receiver
+                    list.mDeliveries++;
+                }
+            }
+        }
+    }
+
+    void MessageBus::deliverThreadSafe(uint32_t begin, uint32_t end)
+    {
+        const void* previousBus = dispatchingBus;
+        dispatchingBus = this;
+
+        for(uint32_t i = begin; i < end; i++)
+        {
+            Delivery& delivery = mThreadSafeDeliveries[i];
+
+            {
+                //handlers on other threads may have removed the subscriber since the deliveries were gathered
+                std::lock_guard<std::recursive_mutex> lock(mSubscribersMutex);
+
+                if(!mSubscribers[delivery.mQueue->getTypeId()].mSubscriptions[delivery.mPosition].mReceiver)
+                {
+                    delivery.mReceiver = nullptr;
+                    continue;
+                }
+            }
+
+#if defined(FEA_MESSAGE_STATS)
+            auto start = std::chrono::high_resolution_clock::now();
+#endif
+            delivery.mQueue->deliver(*delivery.mReceiver);
+#if defined(FEA_MESSAGE_STATS)
+            delivery.mNanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count());
+#endif
+        }
+
+        dispatchingBus = previousBus;
+    }
+
+    void MessageBus::finishThreadSafeDeliveries()
+    {
+        for(const auto& delivery : mThreadSafeDeliveries)
+        {
+#if defined(FEA_MESSAGE_STATS)
+            //handler times are recorded afterwards since the statistics are only updated under the lock
+            if(delivery.mReceiver)
+                recordHandlerCall(delivery.mQueue->getTypeId(), delivery.mNanoseconds);
+#endif
+            endDelivery(mSubscribers[delivery.mQueue->getTypeId()]);
+        }
+
+        mThreadSafeDeliveries.clear();
+    }
 
+    void MessageBus::deliverPosted(bool skipThreadSafe)
+    {
+        const void* previousBus = dispatchingBus;
+        dispatchingBus = this;
 
-        for(const auto subscriber : list)
+        for(auto& queue : mQueues)
         {
-            if(subscriber == receiver)
+            if(queue->isEmpty())
+                continue;
+
+            uint32_t typeId = queue->getTypeId();
+
+#if defined(FEA_MESSAGE_STATS)
+            recordMessages(typeId, queue->getTypeName(), 0, queue->getCount());
+#endif
+
+            if(typeId < mSubscribers.size())
             {
-                existed = true;
-                break;
+                mSubscribers[typeId].mDeliveries++;
+
+                //subscriptions are indexed anew every time since handlers may add subscriptions, which can reallocate the lists
+                size_t count = mSubscribers[typeId].mSubscriptions.size();
+#if defined(FEA_MESSAGE_STATS)
+                uint32_t fanOut = 0;
+#endif
+
+                for(size_t i = 0; i < count; i++)
+                {
+                    Subscription subscription = mSubscribers[typeId].mSubscriptions[i];
+
+                    if(subscription.mReceiver && !(skipThreadSafe && subscription.mThreadSafe))
+                    {
+#if defined(FEA_MESSAGE_STATS)
+                        auto start = std::chrono::high_resolution_clock::now();
+#endif
+                        queue->deliver(*subscription.mReceiver);
+#if defined(FEA_MESSAGE_STATS)
+                        recordHandlerCall(typeId, start);
+#endif
+                    }
+
+#if defined(FEA_MESSAGE_STATS)
+                    //thread-safe subscribers already handed the batch on the thread pool count as well
+                    if(subscription.mReceiver)
+                        fanOut++;
+#endif
+                }
+
+#if defined(FEA_MESSAGE_STATS)
+                recordFanOut(typeId, fanOut);
+#endif
+                endDelivery(mSubscribers[typeId]);
             }
+
+            queue->clear();
+        }
+
+        dispatchingBus = previousBus;
+    }
+
+    bool MessageBus::isDispatching() const
+    {
+        return dispatchingBus == this;
+    }
+
+#if defined(FEA_MESSAGE_STATS)
+    void MessageBus::getStats(std::vector<MessageTypeStats>& stats) const
+    {
+        std::lock_guard<std::recursive_mutex> lock(mSubscribersMutex);
+        stats.clear();
+
+        for(const auto& typeStats : mStats)
+        {
+            if(typeStats.mSendCount > 0 || typeStats.mPostCount > 0)
+                stats.push_back(typeStats);
         }
-        return existed;
     }
+
+    void MessageBus::resetStats()
+    {
+        std::lock_guard<std::recursive_mutex> lock(mSubscribersMutex);
+
+        //the names are kept so that they are only demangled once
+        for(auto& typeStats : mStats)
+            typeStats = MessageTypeStats{typeStats.mName, 0, 0, 0, 0, 0, 0};
+    }
+
+    void MessageBus::recordMessages(uint32_t typeId, const char* typeName, uint32_t sendCount, uint32_t postCount)
+    {
+        if(typeId >= mStats.size())
+            mStats.resize(typeId + 1, MessageTypeStats{"", 0, 0, 0, 0, 0, 0});
+
+        MessageTypeStats& typeStats = mStats[typeId];
+
+        if(typeStats.mName.empty())
+            typeStats.mName = demangle(typeName);
+
+        typeStats.mSendCount += sendCount;
+        typeStats.mPostCount += postCount;
+    }
+
+    void MessageBus::recordFanOut(uint32_t typeId, uint32_t fanOut)
+    {
+        mStats[typeId].mMaxFanOut = std::max(mStats[typeId].mMaxFanOut, fanOut);
+    }
+
+    void MessageBus::recordHandlerCall(uint32_t typeId, std::chrono::high_resolution_clock::time_point start)
+    {
+        recordHandlerCall(typeId, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count()));
+    }
+
+    void MessageBus::recordHandlerCall(uint32_t typeId, uint64_t nanoseconds)
+    {
+        //handlers may send messages of new types, so the statistics are indexed anew after each call
+        MessageTypeStats& typeStats = mStats[typeId];
+        typeStats.mHandlerCallCount++;
+        typeStats.mHandlerNanoseconds += nanoseconds;
+        typeStats.mMaxHandlerNanoseconds = std::max(typeStats.mMaxHandlerNanoseconds, nanoseconds);
+    }
+#endif
 }